@@ -78,7 +78,7 @@
 
 #define CCU6_IEN (0xC0) /*decimal 192*/
 
-#define CCU6_INP (0x400) /*decimal 1024*/
+#define CCU6_INP (0x500) /*decimal 1280*/
 
 #define CCU6_MCMCTR (0x0) /*decimal 0*/
 
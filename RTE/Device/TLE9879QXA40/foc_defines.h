@@ -58,6 +58,8 @@
 
 #define FOC_NOM_CUR (5.00000)
 
+#define FOC_PLL_KP (0x64) /*decimal 100*/
+
 #define FOC_POLE_PAIRS (0x4) /*decimal 4*/
 
 #define FOC_PWM_FREQ (0x4E20) /*decimal 20000*/
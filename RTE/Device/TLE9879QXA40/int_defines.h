@@ -42,15 +42,15 @@
 
 #define CPU_NVIC_IPR1 (0xD010) /*decimal 53264*/
 
-#define CPU_NVIC_IPR2 (0x0) /*decimal 0*/
+#define CPU_NVIC_IPR2 (0xF00000) /*decimal 15728640*/
 
 #define CPU_NVIC_IPR3 (0x0) /*decimal 0*/
 
-#define CPU_NVIC_ISER0 (0x4029) /*decimal 16425*/
+#define CPU_NVIC_ISER0 (0x4429) /*decimal 17449*/
 
 #define CPU_SHPR3 (0x0) /*decimal 0*/
 
-#define CPU_SYSTICK_EN (0x0) /*decimal 0*/
+#define CPU_SYSTICK_EN (0x1) /*decimal 1*/
 
 #define CPU_USAGEFAULT_EN (0x0) /*decimal 0*/
 
@@ -78,7 +78,7 @@
 
 #define SCU_GPT12IEN (0x1) /*decimal 1*/
 
-#define SCU_MODIEN1 (0x0) /*decimal 0*/
+#define SCU_MODIEN1 (0x40) /*decimal 64*/
 
 #define SCU_MODIEN2 (0x0) /*decimal 0*/
 
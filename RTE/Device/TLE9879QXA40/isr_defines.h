@@ -276,9 +276,9 @@
 
 #define CCU6_T13_PM_INT_EN (0x0) /*decimal 0*/
 
-#define CCU6_TRAP_CALLBACK place_your_function_call_back_here
+#define CCU6_TRAP_CALLBACK Emo_HandleTrap
 
-#define CCU6_TRAP_INT_EN (0x0) /*decimal 0*/
+#define CCU6_TRAP_INT_EN (0x1) /*decimal 1*/
 
 #define CCU6_WHE_INT_EN (0x0) /*decimal 0*/
 
@@ -290,7 +290,7 @@
 
 #define CPU_MEMMANAGE_CALLBACK place_your_function_call_back_here
 
-#define CPU_SYSTICK_CALLBACK place_your_function_call_back_here
+#define CPU_SYSTICK_CALLBACK Main_SysTick
 
 #define CPU_USAGEFAULT_CALLBACK place_your_function_call_back_here
 
@@ -518,9 +518,9 @@
 
 #define TIMER3_LB_INT_EN (0x0) /*decimal 0*/
 
-#define UART1_RX_CALLBACK place_your_function_call_back_here
+#define UART1_RX_CALLBACK Lin_HandleRx
 
-#define UART1_RX_INT_EN (0x0) /*decimal 0*/
+#define UART1_RX_INT_EN (0x1) /*decimal 1*/
 
 #define UART1_TX_CALLBACK place_your_function_call_back_here
 
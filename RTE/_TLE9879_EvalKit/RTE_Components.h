@@ -48,6 +48,8 @@
 #define RTE_DEVICE_SDK_PORT
 /* Infineon::Device:SDK:SCU:0.5.4 */
 #define RTE_DEVICE_SDK_SCU
+/* Infineon::Device:SDK:UART:0.2.1 */
+#define RTE_DEVICE_SDK_UART
 /* Infineon::Device:SDK:WDT1:0.3.2 */
 #define RTE_DEVICE_SDK_WDT1
 
@@ -0,0 +1,452 @@
+/*
+ ***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,are permitted provided that the
+ * following conditions are met:
+ *
+ *   Redistributions of source code must retain the above copyright notice, this list of conditions and the  following
+ *   disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *   following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *   Neither the name of the copyright holders nor the names of its contributors may be used to endorse or promote
+ *   products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE  FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY,OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT  OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **********************************************************************************************************************/
+
+/*******************************************************************************
+**                                  Abstract                                  **
+********************************************************************************
+** LIN slave: command, status and diagnostic frames.                          **
+** The frame handling runs completely in Lin_HandleRx, the UART1 receive      **
+** callback of isr.c. UART1 has the lowest priority, so the FOC interrupts    **
+** are never delayed by LIN. A break is received as 0x00 with missing stop    **
+** bit.                                                                       **
+** Response bytes are sent one by one on the read back of the previous byte,  **
+** which also checks for bit errors. A motor start is only requested by the   **
+** interrupt and executed by the main loop, which leaves slow mode before.    **
+** The isr.c UART1 dispatch needs the SDK UART component (Device:SDK:UART of  **
+** TLE987x_DFP 1.5.0, uart.c/uart.h copied into RTE/Device by the RTE).       **
+********************************************************************************
+** Command frame LIN_CFG_ID_CMD (master -> slave, 4 bytes):                   **
+**   [0] bit0: 1 = motor on, 0 = motor off                                    **
+**   [1..2] reference speed in rpm, sint16 little endian                      **
+** Status frame LIN_CFG_ID_STATUS (slave -> master, 8 bytes):                 **
+**   [0] motor state, [1] bit0 response error, bit1 LIN control active,       **
+**   bit2 command timeout, [2..3] actual speed in rpm, [4..5] start error     **
+**   bits, [6] trap count, [7] reserved                                       **
+** Diagnostic frames: Read by Identifier, identifier 0 (product id)           **
+*******************************************************************************/
+
+#include "Lin.h"
+#include "Emo_RAM.h"
+#include "uart_defines.h"
+
+#if (LIN_CFG_ENABLED == 1)
+
+/*******************************************************************************
+**                        Private Function Declarations                       **
+*******************************************************************************/
+static uint8 Lin_lPid(uint8 Id);
+static uint8 Lin_lChecksum(uint8 Pid, const uint8 *pData, uint8 Len);
+static void Lin_lRxByte(uint8 Byte, uint8 StopBit);
+static void Lin_lStartTx(const uint8 *pData, uint8 Len);
+static void Lin_lCommand(void);
+static void Lin_lDiagRequest(void);
+static void Lin_lStatus(uint8 *pData);
+
+/*******************************************************************************
+**                         Global Variable Definitions                        **
+*******************************************************************************/
+TLin_Status Lin_Status;
+
+/*******************************************************************************
+**                         Global Function Definitions                        **
+*******************************************************************************/
+/** \brief Initializes LIN transceiver and UART1.
+ *
+ * \param None
+ * \return None
+ */
+void Lin_Init(void)
+{
+  Lin_Status.State = LIN_STATE_IDLE;
+  LIN_Set_Mode(LIN_MODE_NORMAL);
+  /* Baud rate generator 1 */
+  Lin_SetClockDiv(1u);
+  /* 8 bit UART, receiver enabled */
+  UART1->SCON.reg = (uint8)(UART1_SCON | 0x10u);
+  UART1->SCONCLR.reg = (uint8)0x03u;
+  /* only the receive interrupt is used */
+  SCU->MODIEN1.bit.RIEN1 = 1u;
+} /* End of Lin_Init */
+
+
+/** \brief Stops the motor if the LIN master has control but stopped
+ *  sending commands, to be called cyclically from the main loop.
+ *
+ * \param Tick Time in ms
+ * \return None
+ */
+void Lin_Handler(uint32 Tick)
+{
+  static uint16 LastCount;
+  static uint32 LastTick;
+
+  if (Lin_Status.CmdCount != LastCount)
+  {
+    LastCount = Lin_Status.CmdCount;
+    LastTick = Tick;
+  }
+  else if ((Lin_Status.Run == 1u) && ((Tick - LastTick) >= LIN_CFG_TIMEOUT))
+  {
+    /* master lost, control goes back to the Poti */
+    Lin_Status.Run = 0u;
+    Lin_Status.StartReq = 0u;
+    Lin_Status.Active = 0u;
+    Lin_Status.Timeout = 1u;
+    (void)Emo_StopMotor();
+  }
+  else
+  {
+    /* do nothing */
+  }
+} /* End of Lin_Handler */
+
+
+/** \brief Sets the baud rate generator for a divided system clock.
+ *
+ * The Config Wizard values are valid for the full system clock, in slow
+ * mode BR_VALUE and FD_SEL are divided by the slow down prescaler.
+ *
+ * \param Div Divider of the system clock, 1 = normal operation
+ * \return None
+ */
+void Lin_SetClockDiv(uint32 Div)
+{
+  uint32 Val;
+  /* BR_VALUE * 32 + FD_SEL, rounded */
+  Val = ((((uint32)UART1_BRVAL << 5u) | (uint32)UART1_FD) + (Div >> 1u)) / Div;
+  SCU->BCON1.reg = (uint8)0u;
+  SCU->BGL1.reg = (uint8)Val;
+  SCU->BGH1.reg = (uint8)(Val >> 8u);
+  SCU->BCON1.bit.R = 1u;
+} /* End of Lin_SetClockDiv */
+
+
+/** \brief UART1 receive callback: LIN frame handling.
+ *
+ * Called by UART1_IRQHandler (isr.c), which clears RI afterwards.
+ */
+void Lin_HandleRx(void)
+{
+  uint8 Byte;
+  uint8 StopBit;
+  Byte = UART1->SBUF.reg;
+  StopBit = UART1->SCON.bit.RB8;
+  Lin_lRxByte(Byte, StopBit);
+  /* transmission is handled on the read back */
+  UART1->SCONCLR.reg = (uint8)0x02u;
+} /* End of Lin_HandleRx */
+
+/*******************************************************************************
+**                        Private Function Definitions                        **
+*******************************************************************************/
+/** \brief Calculates the protected identifier (ID with parity bits).
+ */
+static uint8 Lin_lPid(uint8 Id)
+{
+  uint8 P0;
+  uint8 P1;
+  P0 = (uint8)((Id ^ (Id >> 1u) ^ (Id >> 2u) ^ (Id >> 4u)) & 1u);
+  P1 = (uint8)(~((Id >> 1u) ^ (Id >> 3u) ^ (Id >> 4u) ^ (Id >> 5u)) & 1u);
+  return (uint8)((Id & 0x3Fu) | (uint8)(P0 << 6u) | (uint8)(P1 << 7u));
+} /* End of Lin_lPid */
+
+
+/** \brief Calculates the checksum, enhanced (with PID) for signal frames,
+ *  classic for diagnostic frames (Pid = 0).
+ */
+static uint8 Lin_lChecksum(uint8 Pid, const uint8 *pData, uint8 Len)
+{
+  uint16 Sum;
+  uint8 i;
+  Sum = Pid;
+
+  for (i = 0u; i < Len; i++)
+  {
+    Sum += pData[i];
+
+    if (Sum > 0xFFu)
+    {
+      Sum -= 0xFFu;
+    }
+  }
+
+  return (uint8)(~Sum);
+} /* End of Lin_lChecksum */
+
+
+/** \brief Frame state machine, called for every received byte.
+ */
+static void Lin_lRxByte(uint8 Byte, uint8 StopBit)
+{
+  uint8 Id;
+  uint8 Tx[8];
+
+  /* break: dominant for more than one character, any state */
+  if ((Byte == 0u) && (StopBit == 0u))
+  {
+    Lin_Status.State = LIN_STATE_SYNC;
+    return;
+  }
+
+  switch (Lin_Status.State)
+  {
+    case LIN_STATE_SYNC:
+      Lin_Status.State = (Byte == 0x55u) ? LIN_STATE_PID : LIN_STATE_IDLE;
+      break;
+
+    case LIN_STATE_PID:
+      Id = (uint8)(Byte & 0x3Fu);
+      Lin_Status.State = LIN_STATE_IDLE;
+
+      if (Lin_lPid(Id) != Byte)
+      {
+        Lin_Status.Errors++;
+      }
+      else if (Id == LIN_CFG_ID_CMD)
+      {
+        Lin_Status.Pid = Byte;
+        Lin_Status.Len = 4u;
+        Lin_Status.Pos = 0u;
+        Lin_Status.State = LIN_STATE_RX;
+      }
+      else if (Id == LIN_ID_DIAG_REQ)
+      {
+        Lin_Status.Pid = 0u;
+        Lin_Status.Len = 8u;
+        Lin_Status.Pos = 0u;
+        Lin_Status.State = LIN_STATE_RX;
+      }
+      else if (Id == LIN_CFG_ID_STATUS)
+      {
+        Lin_Status.Pid = Byte;
+        Lin_lStatus(Tx);
+        Lin_lStartTx(Tx, 8u);
+        /* response error is reported once */
+        Lin_Status.RespError = 0u;
+      }
+      else if ((Id == LIN_ID_DIAG_RESP) && (Lin_Status.DiagPending == 1u))
+      {
+        Lin_Status.Pid = 0u;
+        Lin_Status.DiagPending = 0u;
+        Lin_lStartTx(Lin_Status.Diag, 8u);
+      }
+      else
+      {
+        /* frame not for this node */
+      }
+
+      break;
+
+    case LIN_STATE_RX:
+      Lin_Status.Data[Lin_Status.Pos] = Byte;
+      Lin_Status.Pos++;
+
+      if (Lin_Status.Pos > Lin_Status.Len)
+      {
+        Lin_Status.State = LIN_STATE_IDLE;
+
+        if (Byte != Lin_lChecksum(Lin_Status.Pid, Lin_Status.Data, Lin_Status.Len))
+        {
+          Lin_Status.Errors++;
+          Lin_Status.RespError = 1u;
+        }
+        else if (Lin_Status.Pid == 0u)
+        {
+          Lin_lDiagRequest();
+        }
+        else
+        {
+          Lin_lCommand();
+        }
+      }
+
+      break;
+
+    case LIN_STATE_TX:
+
+      /* read back of the sent byte */
+      if (Byte != Lin_Status.Data[Lin_Status.Pos])
+      {
+        Lin_Status.Errors++;
+        Lin_Status.RespError = 1u;
+        Lin_Status.State = LIN_STATE_IDLE;
+      }
+      else
+      {
+        Lin_Status.Pos++;
+
+        if (Lin_Status.Pos > Lin_Status.Len)
+        {
+          Lin_Status.State = LIN_STATE_IDLE;
+        }
+        else
+        {
+          UART1->SBUF.reg = Lin_Status.Data[Lin_Status.Pos];
+        }
+      }
+
+      break;
+
+    default:
+      Lin_Status.State = LIN_STATE_IDLE;
+      break;
+  }
+} /* End of Lin_lRxByte */
+
+
+/** \brief Starts the response, further bytes are sent on read back.
+ */
+static void Lin_lStartTx(const uint8 *pData, uint8 Len)
+{
+  uint8 i;
+
+  for (i = 0u; i < Len; i++)
+  {
+    Lin_Status.Data[i] = pData[i];
+  }
+
+  Lin_Status.Data[Len] = Lin_lChecksum(Lin_Status.Pid, pData, Len);
+  Lin_Status.Len = Len;
+  Lin_Status.Pos = 0u;
+  Lin_Status.State = LIN_STATE_TX;
+  UART1->SBUF.reg = Lin_Status.Data[0];
+} /* End of Lin_lStartTx */
+
+
+/** \brief Executes a received command frame.
+ */
+static void Lin_lCommand(void)
+{
+  uint32 State;
+  Lin_Status.Active = 1u;
+  Lin_Status.CmdCount++;
+  Lin_Status.Run = (uint8)(Lin_Status.Data[0] & 1u);
+  Lin_Status.RefSpeed = (sint16)((uint16)Lin_Status.Data[1] | ((uint16)Lin_Status.Data[2] << 8u));
+  Emo_setspeedreferenz((uint16)Lin_Status.RefSpeed);
+  State = Emo_GetMotorState();
+
+  if (Lin_Status.Run == 1u)
+  {
+    if (State == EMO_MOTOR_STATE_STOP)
+    {
+      /* started by the main loop, slow mode is left before */
+      Lin_Status.Timeout = 0u;
+      Lin_Status.StartReq = 1u;
+    }
+  }
+  else
+  {
+    Lin_Status.StartReq = 0u;
+
+    if (State != EMO_MOTOR_STATE_STOP)
+    {
+      (void)Emo_StopMotor();
+    }
+  }
+} /* End of Lin_lCommand */
+
+
+/** \brief Evaluates a master request, prepares the slave response.
+ */
+static void Lin_lDiagRequest(void)
+{
+  uint8 *pReq;
+  uint8 *pResp;
+  uint16 Supplier;
+  uint16 Function;
+  pReq = Lin_Status.Data;
+  pResp = Lin_Status.Diag;
+
+  if ((pReq[0] != LIN_CFG_NAD) && (pReq[0] != LIN_NAD_BROADCAST))
+  {
+    return;
+  }
+
+  /* Read by Identifier */
+  if ((pReq[1] == 0x06u) && (pReq[2] == 0xB2u))
+  {
+    Supplier = (uint16)pReq[4] | ((uint16)pReq[5] << 8u);
+    Function = (uint16)pReq[6] | ((uint16)pReq[7] << 8u);
+
+    if (((Supplier != LIN_CFG_SUPPLIER_ID) && (Supplier != 0x7FFFu)) ||
+        ((Function != LIN_CFG_FUNCTION_ID) && (Function != 0xFFFFu)))
+    {
+      return;
+    }
+
+    pResp[0] = LIN_CFG_NAD;
+
+    if (pReq[3] == 0u)
+    {
+      /* product identification */
+      pResp[1] = 0x06u;
+      pResp[2] = 0xF2u;
+      pResp[3] = (uint8)LIN_CFG_SUPPLIER_ID;
+      pResp[4] = (uint8)(LIN_CFG_SUPPLIER_ID >> 8u);
+      pResp[5] = (uint8)LIN_CFG_FUNCTION_ID;
+      pResp[6] = (uint8)(LIN_CFG_FUNCTION_ID >> 8u);
+      pResp[7] = LIN_CFG_VARIANT;
+    }
+    else
+    {
+      /* negative response: subfunction not supported */
+      pResp[1] = 0x03u;
+      pResp[2] = 0x7Fu;
+      pResp[3] = 0xB2u;
+      pResp[4] = 0x12u;
+      pResp[5] = 0xFFu;
+      pResp[6] = 0xFFu;
+      pResp[7] = 0xFFu;
+    }
+
+    Lin_Status.DiagPending = 1u;
+  }
+} /* End of Lin_lDiagRequest */
+
+
+/** \brief Fills the status frame.
+ */
+static void Lin_lStatus(uint8 *pData)
+{
+  uint16 Speed;
+  Speed = (uint16)Emo_Ctrl.ActSpeeddisplay;
+  pData[0] = (uint8)Emo_GetMotorState();
+  pData[1] = (uint8)(Lin_Status.RespError | (uint8)(Lin_Status.Active << 1u) | (uint8)(Lin_Status.Timeout << 2u));
+  pData[2] = (uint8)Speed;
+  pData[3] = (uint8)(Speed >> 8u);
+  pData[4] = (uint8)Emo_Status.MotorStartError;
+  pData[5] = (uint8)(Emo_Status.MotorStartError >> 8u);
+#if (EMO_CFG_CTRAP_ENABLED == 1)
+  pData[6] = (uint8)Emo_Status.TrapCount;
+#else
+  pData[6] = 0u;
+#endif
+  pData[7] = 0xFFu;
+} /* End of Lin_lStatus */
+
+#endif /* (LIN_CFG_ENABLED == 1) */
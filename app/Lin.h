@@ -0,0 +1,107 @@
+/*
+ ***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,are permitted provided that the
+ * following conditions are met:
+ *
+ *   Redistributions of source code must retain the above copyright notice, this list of conditions and the  following
+ *   disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *   following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *   Neither the name of the copyright holders nor the names of its contributors may be used to endorse or promote
+ *   products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE  FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY,OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT  OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **********************************************************************************************************************/
+
+#ifndef LIN_APP_H
+#define LIN_APP_H
+
+/*******************************************************************************
+**                                  Includes                                  **
+*******************************************************************************/
+#include "tle_device.h"
+
+/*******************************************************************************
+**                   Global Macro Definitions to be changed                   **
+*******************************************************************************/
+/* LIN slave enable, UART1 with the LIN baud rate of the Config Wizard
+ * Range: 0=disabled, 1=enabled */
+#define LIN_CFG_ENABLED (1)
+
+/* Frame identifiers */
+#define LIN_CFG_ID_CMD (0x10u)
+#define LIN_CFG_ID_STATUS (0x11u)
+
+/* Node address and product identification for diagnostic frames */
+#define LIN_CFG_NAD (0x0Au)
+#define LIN_CFG_SUPPLIER_ID (0x0000u)
+#define LIN_CFG_FUNCTION_ID (0x0001u)
+#define LIN_CFG_VARIANT (0x01u)
+
+/* Motor is stopped if no command frame is received within this time in ms */
+#define LIN_CFG_TIMEOUT (1000u)
+
+/*******************************************************************************
+**             Derived Global Macro Definitions not to be changed             **
+*******************************************************************************/
+#define LIN_ID_DIAG_REQ     (0x3Cu)
+#define LIN_ID_DIAG_RESP    (0x3Du)
+#define LIN_NAD_BROADCAST   (0x7Fu)
+
+/* Frame states */
+#define LIN_STATE_IDLE      (0u)
+#define LIN_STATE_SYNC      (1u)
+#define LIN_STATE_PID       (2u)
+#define LIN_STATE_RX        (3u)
+#define LIN_STATE_TX        (4u)
+
+/*******************************************************************************
+**                           Global Type Definitions                          **
+*******************************************************************************/
+/** \brief LIN slave status */
+typedef struct
+{
+  uint8 State;                    /**< \brief Frame state LIN_STATE_x */
+  uint8 Pid;                      /**< \brief Protected identifier of the actual frame */
+  uint8 Len;                      /**< \brief Data length of the actual frame */
+  uint8 Pos;                      /**< \brief Byte position in the actual frame */
+  uint8 Data[9];                  /**< \brief Data and checksum of the actual frame */
+  uint8 Diag[8];                  /**< \brief Pending diagnostic response */
+  uint8 DiagPending;              /**< \brief Diagnostic response available */
+  uint8 RespError;                /**< \brief Response error, sent in status frame */
+  uint8 Active;                   /**< \brief LIN master has control of the motor */
+  uint8 Run;                      /**< \brief Requested motor on/off */
+  uint8 StartReq;                 /**< \brief Motor start requested, executed by the main loop */
+  uint8 Timeout;                  /**< \brief Motor stopped by command timeout */
+  sint16 RefSpeed;                /**< \brief Requested speed in rpm */
+  uint16 CmdCount;                /**< \brief Received command frames */
+  uint16 Errors;                  /**< \brief Parity, checksum and bit errors */
+} TLin_Status;
+
+/*******************************************************************************
+**                        Global Variable Declarations                        **
+*******************************************************************************/
+extern TLin_Status Lin_Status;
+
+/*******************************************************************************
+**                        Global Function Declarations                        **
+*******************************************************************************/
+extern void Lin_Init(void);
+extern void Lin_Handler(uint32 Tick);
+extern void Lin_SetClockDiv(uint32 Div);
+extern void Lin_HandleRx(void);
+
+#endif /* LIN_APP_H */
@@ -60,30 +60,231 @@
 
 #include "tle_device.h"
 #include "Emo_RAM.h"
+#include "Emo_Rec.h"
+#include "Nvm.h"
+#include "Lin.h"
+
+/* Low power main loop: the CPU sleeps (WFI) until the next interrupt, the
+ * main tasks run on the 1ms SysTick, slow mode while the motor is stopped
+ * Range: 0=disabled (busy loop), 1=enabled */
+#define MAIN_CFG_LOWPOWER_ENABLED (1)
+
+/* Period of the Poti evaluation in ms */
+#define MAIN_POTI_PERIOD (10u)
+
+/* Time in stop state before slow mode is entered in ms */
+#define MAIN_SLOW_DELAY (1000u)
+
+/* System clock divider in slow mode, as prescaler setting and as value */
+#define MAIN_SLOW_PRESCALER (SLOWDOWN_PRESCALER_8)
+#define MAIN_SLOW_DIV (8u)
+
+/** \brief Main loop statistics */
+typedef struct
+{
+  uint32 Loops;                   /**< \brief Main loop iterations in the last second */
+  uint32 Wakeups;                 /**< \brief Wake-ups from sleep in the last second */
+  uint32 LoopCount;               /**< \brief Main loop iterations, running count */
+  uint32 WakeupCount;             /**< \brief Wake-ups from sleep, running count */
+  uint16 SecCount;                /**< \brief ms counter for the statistics */
+  uint16 StopCount;               /**< \brief ms counter in stop state */
+  uint16 PotiCount;               /**< \brief ms counter for the Poti evaluation */
+  uint8 SlowMode;                 /**< \brief Slow mode active */
+} TMain_Stat;
+
+TMain_Stat Main_Stat;
+/* 1ms tick, incremented by the SysTick interrupt */
+volatile uint32 Main_Tick;
 
 static void Main_lStartMotor(void);
 static void Main_lStopMotor(void);
+#if (MAIN_CFG_LOWPOWER_ENABLED == 1)
+static void Main_lTick(uint32 Elapsed);
+static void Main_lExitSlowMode(void);
+static void Main_lSleep(void);
+#endif
+void Main_SysTick(void);
 void Poti_Handler(void);
 
 int main(void)
 {
+#if (MAIN_CFG_LOWPOWER_ENABLED == 1)
+  uint32 LastTick;
+  uint32 Elapsed;
+#endif
   /* Initialization of hardware modules based on Config Wizard configuration */
   TLE_Init();
   Emo_Init();
+#if (LIN_CFG_ENABLED == 1)
+  Lin_Init();
+#endif
+#if (NVM_CFG_ENABLED == 1)
+  Nvm_Init();
+#endif
+#if (MAIN_CFG_LOWPOWER_ENABLED == 1)
+  LastTick = Main_Tick;
+#endif
 
   for (;;)
   {
+#if (MAIN_CFG_LOWPOWER_ENABLED == 1)
+    Main_Stat.LoopCount++;
+
+    /* all ticks since the last call, the loop may take longer than 1ms */
+    Elapsed = Main_Tick - LastTick;
+
+    if (Elapsed != 0u)
+    {
+      LastTick += Elapsed;
+      Main_lTick(Elapsed);
+    }
+
+#else
     /* Watchdog Service */
     (void)WDT1_Service();
     Poti_Handler();
+#endif
+#if (EMO_CFG_REC_ENABLED == 1)
+    /* send flight record after a fault */
+    Emo_RecDump();
+#endif
+#if (NVM_CFG_ENABLED == 1)
+    Nvm_Handler(Main_Tick);
+#endif
+#if (LIN_CFG_ENABLED == 1)
+    Lin_Handler(Main_Tick);
+
+    if (Lin_Status.StartReq == 1u)
+    {
+      /* start of the LIN master, same path as the Poti start */
+      Lin_Status.StartReq = 0u;
+
+      if (Lin_Status.Run == 1u)
+      {
+        Main_lStartMotor();
+      }
+    }
+#endif
+#if (MAIN_CFG_LOWPOWER_ENABLED == 1)
+    Main_lSleep();
+#endif
   }
 }
 
 
+#if (MAIN_CFG_LOWPOWER_ENABLED == 1)
+/* Tasks of the 1ms tick, Elapsed ticks since the last call */
+static void Main_lTick(uint32 Elapsed)
+{
+  bool Idle;
+  /* Watchdog Service, WDT1_Service waits for the open window itself */
+  (void)WDT1_Service();
+  Main_Stat.PotiCount += (uint16)Elapsed;
+
+  if (Main_Stat.PotiCount >= MAIN_POTI_PERIOD)
+  {
+    Main_Stat.PotiCount = 0u;
+    Poti_Handler();
+  }
+
+  /* statistics of the last second */
+  Main_Stat.SecCount += (uint16)Elapsed;
+
+  if (Main_Stat.SecCount >= 1000u)
+  {
+    Main_Stat.SecCount -= 1000u;
+    Main_Stat.Loops = Main_Stat.LoopCount;
+    Main_Stat.Wakeups = Main_Stat.WakeupCount;
+    Main_Stat.LoopCount = 0u;
+    Main_Stat.WakeupCount = 0u;
+  }
+
+  /* slow mode only if no clock dependent job is running */
+  Idle = (Emo_GetMotorState() == EMO_MOTOR_STATE_STOP);
+#if (EMO_CFG_REC_ENABLED == 1)
+  Idle = Idle && (Emo_Rec.DumpState != EMO_REC_DUMP_RUN);
+#endif
+#if (NVM_CFG_ENABLED == 1)
+  Idle = Idle && (Nvm_Status.Pending == 0u);
+#endif
+
+  if (Idle == true)
+  {
+    if (Main_Stat.StopCount < MAIN_SLOW_DELAY)
+    {
+      Main_Stat.StopCount += (uint16)Elapsed;
+    }
+    else if (Main_Stat.SlowMode == 0u)
+    {
+      SCU_EnterSlowMode(MAIN_SLOW_PRESCALER);
+#if (LIN_CFG_ENABLED == 1)
+      /* the LIN baud rate is derived from the system clock */
+      Lin_SetClockDiv(MAIN_SLOW_DIV);
+#endif
+      Main_Stat.SlowMode = 1u;
+    }
+    else
+    {
+      /* do nothing */
+    }
+  }
+  else
+  {
+    Main_Stat.StopCount = 0u;
+    Main_lExitSlowMode();
+  }
+}
+
+
+/* Back to the full system clock */
+static void Main_lExitSlowMode(void)
+{
+  if (Main_Stat.SlowMode == 1u)
+  {
+    SCU_ExitSlowMode();
+#if (LIN_CFG_ENABLED == 1)
+    Lin_SetClockDiv(1u);
+#endif
+    Main_Stat.SlowMode = 0u;
+  }
+}
+
+
+/* Sleep until the next interrupt (SysTick, GPT12E, ADC1, CCU6, LIN) */
+static void Main_lSleep(void)
+{
+#if (EMO_CFG_REC_ENABLED == 1)
+
+  /* UART transmission of the flight record is polled */
+  if (Emo_Rec.DumpState == EMO_REC_DUMP_RUN)
+  {
+    return;
+  }
+
+#endif
+  __WFI();
+  Main_Stat.WakeupCount++;
+}
+#endif
+
+
+/* SysTick callback, every 1ms */
+void Main_SysTick(void)
+{
+  Main_Tick++;
+}
+
+
 static void Main_lStartMotor(void)
 {
   uint32 Error;
   Error = EMO_ERROR_NONE;
+#if (MAIN_CFG_LOWPOWER_ENABLED == 1)
+
+  /* PWM and FOC timing need the full system clock */
+  Main_lExitSlowMode();
+  Main_Stat.StopCount = 0u;
+#endif
 
   if (Error == EMO_ERROR_NONE)
   {
@@ -116,12 +317,28 @@ static void Main_lStopMotor(void)
 /* In case the VCP supply fails the motor stops */
 void BDRV_Diag_Supply(void)
 {
+#if (EMO_CFG_REC_ENABLED == 1)
+  /* cause first, the trap interrupt preempts and would record its own */
+  Emo_RecTrigger(EMO_REC_CAUSE_BDRV_VCP);
+#endif
+#if (EMO_CFG_CTRAP_ENABLED == 1)
+  /* PWM outputs passive */
+  CCU6_Trap_Flag_Int_Set();
+#endif
   Main_lStopMotor();
 }
 
 /* iI case an overcurrent is detected on one of the MOSFETs, the motor will be switched off */
 void BDRV_Diag(void)
 {
+#if (EMO_CFG_REC_ENABLED == 1)
+  /* cause first, the trap interrupt preempts and would record its own */
+  Emo_RecTrigger(EMO_REC_CAUSE_BDRV_OC);
+#endif
+#if (EMO_CFG_CTRAP_ENABLED == 1)
+  /* PWM outputs passive */
+  CCU6_Trap_Flag_Int_Set();
+#endif
   Main_lStopMotor();
 }
 
@@ -129,6 +346,15 @@ void BDRV_Diag(void)
 void Poti_Handler(void)
 {
   uint16 mV;
+#if (LIN_CFG_ENABLED == 1)
+
+  /* the LIN master has control of the motor */
+  if (Lin_Status.Active == 1u)
+  {
+    return;
+  }
+
+#endif
 
   /* Read the value at Ch4 (Poti) in mV - values between 0 and 5000 are possible */
   if (ADC1_GetChResult_mV(&mV, ADC1_CH4) == true)
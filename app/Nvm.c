@@ -0,0 +1,329 @@
+/*
+ ***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,are permitted provided that the
+ * following conditions are met:
+ *
+ *   Redistributions of source code must retain the above copyright notice, this list of conditions and the  following
+ *   disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *   following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *   Neither the name of the copyright holders nor the names of its contributors may be used to endorse or promote
+ *   products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE  FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY,OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT  OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **********************************************************************************************************************/
+
+/*******************************************************************************
+**                                  Abstract                                  **
+********************************************************************************
+** Persistence of motor runtime and learned motor parameters in the data      **
+** flash. ProgramPage disables all interrupts during programming, therefore   **
+** a write request is only executed while the motor is stopped (PWM off).     **
+** The stop state is checked again with interrupts disabled and they stay     **
+** disabled until ProgramPage returns, so a start by the LIN interrupt cannot **
+** slip in between.                                                           **
+** Records are written round robin into NVM_CFG_LOG_PAGES pages, the valid    **
+** record with the highest sequence number is the actual one. A failed or     **
+** interrupted write leaves the previous record untouched.                    **
+*******************************************************************************/
+
+#include "Nvm.h"
+#include "Emo_RAM.h"
+
+#if (NVM_CFG_ENABLED == 1)
+
+/*******************************************************************************
+**                        Private Function Declarations                       **
+*******************************************************************************/
+static uint16 Nvm_lCrc16(const uint8 *pData, uint32 Len);
+static bool Nvm_lIsValid(const TNvm_Record *pRec);
+static void Nvm_lWrite(void);
+
+/*******************************************************************************
+**                         Global Variable Definitions                        **
+*******************************************************************************/
+TNvm_Status Nvm_Status;
+
+/*******************************************************************************
+**                        Private Variable Definitions                        **
+*******************************************************************************/
+static uint8 Nvm_PageBuf[FlashPageSize];
+
+/*******************************************************************************
+**                         Global Function Definitions                        **
+*******************************************************************************/
+/** \brief Reads the newest valid record and restores the learned parameters.
+ *
+ * \param None
+ * \return None
+ *
+ * \note Emo_Init has to be called before.
+ */
+void Nvm_Init(void)
+{
+  uint16 Page;
+  bool Found;
+  const TNvm_Record *pRec;
+  Found = false;
+
+  for (Page = 0u; Page < NVM_CFG_LOG_PAGES; Page++)
+  {
+    /* violation: cast from unsigned int to pointer [MISRA Rule 45] */
+    pRec = (const TNvm_Record *)(NVM_LOG_START + ((uint32)Page * FlashPageSize));
+
+    if (Nvm_lIsValid(pRec) == true)
+    {
+      if ((Found == false) || (pRec->Seq > Nvm_Status.Data.Seq))
+      {
+        Nvm_Status.Data = *pRec;
+        Nvm_Status.Page = Page;
+        Found = true;
+      }
+    }
+  }
+
+  if (Found == true)
+  {
+#if (EMO_CFG_IDENT_ENABLED == 1)
+    /* continue with the parameters of the last identification, outdated **
+    ** parameters are start values of a new identification              */
+    Emo_SetPhasePar(Nvm_Status.Data.PhaseRes, Nvm_Status.Data.PhaseInd);
+
+    if ((Nvm_Status.Data.RunTime - Nvm_Status.Data.IdentRunTime) < NVM_CFG_IDENT_AGE)
+    {
+      Emo_Ident.Done = 1u;
+    }
+
+#endif
+  }
+  else
+  {
+    /* empty log: first write goes to page 0 */
+    Nvm_Status.Data.Magic = NVM_MAGIC;
+    Nvm_Status.Data.Seq = 0u;
+    Nvm_Status.Data.RunTime = 0u;
+#if (EMO_CFG_IDENT_ENABLED == 1)
+    Nvm_Status.Data.PhaseRes = Emo_Ident.PhaseResAct;
+    Nvm_Status.Data.PhaseInd = Emo_Ident.PhaseIndAct;
+#endif
+    Nvm_Status.Data.IdentRunTime = 0u;
+    Nvm_Status.Page = NVM_CFG_LOG_PAGES - 1u;
+  }
+
+  Nvm_Status.SavedRunTime = Nvm_Status.Data.RunTime;
+  Nvm_Status.LastTick = 0u;
+  Nvm_Status.Pending = 0u;
+  Nvm_Status.Ms = 0u;
+  Nvm_Status.Errors = 0u;
+#if (EMO_CFG_IDENT_ENABLED == 1)
+  Nvm_Status.IdentDone = Emo_Ident.Done;
+#endif
+} /* End of Nvm_Init */
+
+
+/** \brief Requests a write of the RAM mirror, executed at next motor stop.
+ *
+ * \param None
+ * \return None
+ */
+void Nvm_RequestWrite(void)
+{
+  Nvm_Status.Pending = 1u;
+} /* End of Nvm_RequestWrite */
+
+
+/** \brief Counts motor runtime and commits pending writes, to be called
+ *  cyclically from the main loop.
+ *
+ * \param Tick Time in ms
+ * \return None
+ */
+void Nvm_Handler(uint32 Tick)
+{
+  uint32 State;
+  uint32 Elapsed;
+  State = Emo_GetMotorState();
+  /* all ms since the last call, the main loop may be slower than 1ms */
+  Elapsed = Tick - Nvm_Status.LastTick;
+  Nvm_Status.LastTick = Tick;
+
+  if ((State != EMO_MOTOR_STATE_STOP) && (State != EMO_MOTOR_STATE_UNINIT))
+  {
+    Nvm_Status.Ms += Elapsed;
+
+    if (Nvm_Status.Ms >= 1000u)
+    {
+      Nvm_Status.Data.RunTime += Nvm_Status.Ms / 1000u;
+      Nvm_Status.Ms = Nvm_Status.Ms % 1000u;
+    }
+  }
+
+  /* PWM is off only in stop state => no FOC interrupt to be blocked */
+  if (State == EMO_MOTOR_STATE_STOP)
+  {
+#if (EMO_CFG_IDENT_ENABLED == 1)
+
+    if ((Emo_Ident.Done == 1u) && (Nvm_Status.IdentDone == 0u))
+    {
+      /* identification executed, also if it kept the parameters */
+      Nvm_Status.Data.IdentRunTime = Nvm_Status.Data.RunTime;
+      Nvm_Status.Pending = 1u;
+    }
+
+    Nvm_Status.IdentDone = Emo_Ident.Done;
+
+    if ((Nvm_Status.Data.PhaseRes != Emo_Ident.PhaseResAct) ||
+        (Nvm_Status.Data.PhaseInd != Emo_Ident.PhaseIndAct))
+    {
+      Nvm_Status.Data.PhaseRes = Emo_Ident.PhaseResAct;
+      Nvm_Status.Data.PhaseInd = Emo_Ident.PhaseIndAct;
+      Nvm_Status.Pending = 1u;
+    }
+
+#endif
+
+    if ((Nvm_Status.Data.RunTime - Nvm_Status.SavedRunTime) >= NVM_CFG_RUNTIME_STEP)
+    {
+      Nvm_Status.Pending = 1u;
+    }
+
+    /* after a failure each page is tried once */
+    if ((Nvm_Status.Pending == 1u) && (Nvm_Status.Errors < NVM_CFG_LOG_PAGES))
+    {
+      Nvm_lWrite();
+    }
+  }
+} /* End of Nvm_Handler */
+
+
+/** \brief Returns the motor runtime in hours.
+ *
+ * \param None
+ * \return Runtime in h
+ */
+uint32 Nvm_GetRunTimeHours(void)
+{
+  return Nvm_Status.Data.RunTime / 3600u;
+} /* End of Nvm_GetRunTimeHours */
+
+/*******************************************************************************
+**                        Private Function Definitions                        **
+*******************************************************************************/
+/** \brief Calculates CRC-16 CCITT (polynomial 0x1021, init 0xFFFF).
+ */
+static uint16 Nvm_lCrc16(const uint8 *pData, uint32 Len)
+{
+  uint16 Crc;
+  uint32 i;
+  uint8 j;
+  Crc = 0xFFFFu;
+
+  for (i = 0u; i < Len; i++)
+  {
+    Crc ^= (uint16)((uint16)pData[i] << 8u);
+
+    for (j = 0u; j < 8u; j++)
+    {
+      if ((Crc & 0x8000u) != 0u)
+      {
+        Crc = (uint16)((uint16)(Crc << 1u) ^ 0x1021u);
+      }
+      else
+      {
+        Crc = (uint16)(Crc << 1u);
+      }
+    }
+  }
+
+  return Crc;
+} /* End of Nvm_lCrc16 */
+
+
+/** \brief Checks magic and CRC of a record.
+ */
+static bool Nvm_lIsValid(const TNvm_Record *pRec)
+{
+  bool Res;
+  Res = false;
+
+  if (pRec->Magic == NVM_MAGIC)
+  {
+    if (pRec->Crc == Nvm_lCrc16((const uint8 *)pRec, sizeof(TNvm_Record) - 2u))
+    {
+      Res = true;
+    }
+  }
+
+  return Res;
+} /* End of Nvm_lIsValid */
+
+
+/** \brief Writes the RAM mirror into the next log page.
+ */
+static void Nvm_lWrite(void)
+{
+  uint16 Page;
+  uint32 i;
+  uint32 Res;
+  const uint8 *pData;
+  /* a LIN command may have started the motor since the check in **
+  ** Nvm_Handler: check again, no interrupt until ProgramPage ends */
+  __disable_irq();
+
+  if (Emo_GetMotorState() != EMO_MOTOR_STATE_STOP)
+  {
+    __enable_irq();
+    return;
+  }
+
+  Page = (uint16)((Nvm_Status.Page + 1u) % NVM_CFG_LOG_PAGES);
+  Nvm_Status.Data.Seq++;
+  Nvm_Status.Data.Reserved = 0xFFFFu;
+  Nvm_Status.Data.Crc = Nvm_lCrc16((const uint8 *)&Nvm_Status.Data, sizeof(TNvm_Record) - 2u);
+  pData = (const uint8 *)&Nvm_Status.Data;
+
+  for (i = 0u; i < FlashPageSize; i++)
+  {
+    if (i < sizeof(TNvm_Record))
+    {
+      Nvm_PageBuf[i] = pData[i];
+    }
+    else
+    {
+      Nvm_PageBuf[i] = 0xFFu;
+    }
+  }
+
+  /* no RAM branch, corrective actions enabled, old data kept on fail */
+  Res = ProgramPage(NVM_LOG_START + ((uint32)Page * FlashPageSize), Nvm_PageBuf, 0u, 1u, 0u);
+  __enable_irq();
+
+  if (Res == 0u)
+  {
+    Nvm_Status.SavedRunTime = Nvm_Status.Data.RunTime;
+    Nvm_Status.Pending = 0u;
+    Nvm_Status.Errors = 0u;
+  }
+  else
+  {
+    /* next attempt uses the following page */
+    Nvm_Status.Errors++;
+  }
+
+  Nvm_Status.Page = Page;
+} /* End of Nvm_lWrite */
+
+#endif /* (NVM_CFG_ENABLED == 1) */
@@ -0,0 +1,103 @@
+/*
+ ***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,are permitted provided that the
+ * following conditions are met:
+ *
+ *   Redistributions of source code must retain the above copyright notice, this list of conditions and the  following
+ *   disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *   following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *   Neither the name of the copyright holders nor the names of its contributors may be used to endorse or promote
+ *   products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE  FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY,OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT  OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **********************************************************************************************************************/
+
+#ifndef NVM_H
+#define NVM_H
+
+/*******************************************************************************
+**                                  Includes                                  **
+*******************************************************************************/
+#include "tle_device.h"
+
+/*******************************************************************************
+**                   Global Macro Definitions to be changed                   **
+*******************************************************************************/
+/* NVM service enable
+ * Range: 0=disabled, 1=enabled */
+#define NVM_CFG_ENABLED (1)
+
+/* Number of data flash pages used for the record log (wear levelling)
+ * Range: 2..32 */
+#define NVM_CFG_LOG_PAGES (8u)
+
+/* Additional motor runtime in s before a new record is written */
+#define NVM_CFG_RUNTIME_STEP (60u)
+
+/* Max. motor runtime in s since the identification, older parameters are
+ * only used as start values and the motor is identified again */
+#define NVM_CFG_IDENT_AGE (36000u)
+
+/*******************************************************************************
+**             Derived Global Macro Definitions not to be changed             **
+*******************************************************************************/
+#define NVM_LOG_START       (DataFlashStart)
+#define NVM_MAGIC           (0x4E564D32u)
+
+/*******************************************************************************
+**                           Global Type Definitions                          **
+*******************************************************************************/
+/** \brief NVM record, one per data flash page */
+typedef struct
+{
+  uint32 Magic;                   /**< \brief NVM_MAGIC */
+  uint32 Seq;                     /**< \brief Sequence number, newest record has the highest */
+  uint32 RunTime;                 /**< \brief Motor runtime in s */
+  uint32 PhaseRes;                /**< \brief Learned phase resistance, see Emo_SetPhasePar */
+  uint32 PhaseInd;                /**< \brief Learned phase inductance, see Emo_SetPhasePar */
+  uint32 IdentRunTime;            /**< \brief Motor runtime in s at the identification */
+  uint16 Reserved;
+  uint16 Crc;                     /**< \brief CRC-16 (CCITT) of all bytes before */
+} TNvm_Record;
+
+/** \brief NVM service status */
+typedef struct
+{
+  TNvm_Record Data;               /**< \brief RAM mirror of the newest record */
+  uint32 SavedRunTime;            /**< \brief Runtime of the newest record in the data flash */
+  uint32 LastTick;                /**< \brief Tick of the last Nvm_Handler call */
+  uint32 Ms;                      /**< \brief Millisecond counter for runtime */
+  uint16 Page;                    /**< \brief Log page of the newest record */
+  uint16 Pending;                 /**< \brief Write requested */
+  uint16 Errors;                  /**< \brief Failed page writes since last success */
+  uint16 IdentDone;               /**< \brief Emo_Ident.Done of the last call */
+} TNvm_Status;
+
+/*******************************************************************************
+**                        Global Variable Declarations                        **
+*******************************************************************************/
+extern TNvm_Status Nvm_Status;
+
+/*******************************************************************************
+**                        Global Function Declarations                        **
+*******************************************************************************/
+extern void Nvm_Init(void);
+extern void Nvm_RequestWrite(void);
+extern void Nvm_Handler(uint32 Tick);
+extern uint32 Nvm_GetRunTimeHours(void);
+
+#endif /* NVM_H */
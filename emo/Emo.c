@@ -41,6 +41,7 @@
 *******************************************************************************/
 
 #include "Emo_RAM.h"
+#include "Emo_Rec.h"
 #include "foc_defines.h"
 #include "scu_defines.h"
 #include "gpt12e_defines.h"
@@ -69,8 +70,32 @@ uint32 Emo_Init(void)
   }
 
   GPT12E_T2_Start();
+#if (EMO_CFG_CTRAP_ENABLED == 1)
+  /* Trap on all six outputs. The trap flag is cleared by isr.c after
+   * Emo_HandleTrap, the trap state is left at the next T12 zero match
+   * with inactive trap input; the bridge is already off then. */
+  CCU6_Trap_Channel_En(0x3Fu);
+  CCU6_Trap_SW_Clr_En();
+  CCU6_Trap_T12_ZM_Exit_En();
+#if (EMO_CFG_CTRAP_PIN != 0)
+  CCU6_Trap_Input_Sel((uint16)(EMO_CFG_CTRAP_PIN - 1));
+  CCU6_Trap_Pin_En();
+#endif
+  CCU6_TRAP_Int_Clr();
+  CCU6_TRAP_Int_En();
+#endif
   /* Initialize FOC parameters */
   Emo_lInitFocPar();
+#if (EMO_CFG_REC_ENABLED == 1)
+  /* Initialize flight recorder */
+  Emo_RecInit();
+#endif
+#if (EMO_CFG_JITTER_MON_ENABLED == 1)
+  Emo_JitReset();
+#endif
+#if (EMO_CFG_SAT_COUNT_ENABLED == 1)
+  Emo_SatReset();
+#endif
   /* Initialize motor state */
   Emo_Status.MotorState = EMO_MOTOR_STATE_STOP;
   /* Return without error */
@@ -130,6 +155,20 @@ uint32 Emo_StartMotor(uint32 EnableBridge)
     return EMO_ERROR_MOTOR_NOT_STOPPED;
   }
 
+#if (EMO_CFG_REC_ENABLED == 1)
+  /* a pending fault stop must not stop the PWM of this start */
+  Emo_Rec.StopPending = 0u;
+#endif
+#if (EMO_CFG_CTRAP_ENABLED == 1)
+  /* Release trap, outputs are enabled at the first T12 zero match */
+  CCU6_TRAP_Int_Clr();
+  CCU6_TRAP_Int_En();
+#endif
+#if (EMO_CFG_CSA_OFFS_BACKGROUND == 1)
+  /* current measurement synchronous to the PWM again */
+  ADC1_ESM_Trigger_Select(ADC1_Trigg_CCU6_Ch3);
+  GPT12E_T3_Stop();
+#endif
   /* Start PWM */
   CCU6_StartTmr_T12();
   /* Disable output pattern */
@@ -142,13 +181,111 @@ uint32 Emo_StartMotor(uint32 EnableBridge)
   BDRV_Set_Bridge(Ch_PWM, Ch_PWM, Ch_PWM, Ch_PWM, Ch_PWM, Ch_PWM);
   /* Initialize variables */
   Emo_lInitFocVar();
+#if (EMO_CFG_REC_ENABLED == 1)
+
+  /* keep a fault record until it has been sent */
+  if ((Emo_Rec.Cause <= EMO_REC_CAUSE_STOP) || (Emo_Rec.DumpState == EMO_REC_DUMP_DONE))
+  {
+    Emo_RecArm();
+  }
+
+#endif
+#if (EMO_CFG_CATCH_ENABLED == 1)
+  /* observe motor with zero current before applying the start procedure */
+  Emo_Ctrl.CatchCount = Emo_Ctrl.CatchTime;
+
+  /* no offset estimation with Amp=0, this would short-circuit a rotating **
+  ** motor: use offset of previous start, without a plausible estimate   **
+  ** of a previous start the offset of initialization                    */
+  if ((Emo_Svm.CsaOffsetAdw < EMO_CSA_OFFS_MIN) || (Emo_Svm.CsaOffsetAdw > EMO_CSA_OFFS_MAX))
+  {
+    Emo_Svm.CsaOffsetAdw = Emo_Svm.CsaOffset;
+  }
+
+  Emo_Svm.CounterOffsetAdw = 128;
+  Emo_Status.MotorState = EMO_MOTOR_STATE_CATCH;
+#else
   /* Set start state */
-  Emo_Status.MotorState = EMO_MOTOR_STATE_START;
+  Emo_lSetStartState();
+#endif
   /* Return without error */
   return EMO_ERROR_NONE;
 } /* End of Emo_StartMotor */
 
 
+/** \brief Sets the state of the start procedure.
+ *
+ * \param None
+ * \return None
+ *
+ * \note Emo_lInitFocVar has to be called before.
+ *
+ * \ingroup emo_api
+ */
+void Emo_lSetStartState(void)
+{
+#if (EMO_CFG_IDENT_ENABLED == 1)
+
+  if (Emo_Ident.Done == 0u)
+  {
+    /* identify phase resistance and inductance before first start */
+    Emo_lInitIdentVar();
+    Emo_Status.MotorState = EMO_MOTOR_STATE_IDENT;
+    return;
+  }
+
+#endif
+#if (EMO_CFG_IPD_ENABLED == 1)
+  /* detect rotor position instead of alignment */
+  Emo_lInitIpdVar();
+  Emo_Status.MotorState = EMO_MOTOR_STATE_IPD;
+#else
+  Emo_Status.MotorState = EMO_MOTOR_STATE_START;
+#endif
+} /* End of Emo_lSetStartState */
+
+
+#if (EMO_CFG_CATCH_ENABLED == 1)
+/** \brief Returns the load current of a caught motor.
+ *
+ * During the catch spin observation the q-current is regulated to 0, the
+ * speed change in the second half of the observation time is caused by
+ * the load only: iL = -dSpeed / (Inertia * CatchTime/2).
+ * Without load observer no inertia is known and 0 is returned.
+ *
+ * \param None
+ * \return Load current (real), limited to the speed regulator limits
+ *
+ * \ingroup emo_api
+ */
+sint32 Emo_lCatchLoad(void)
+{
+#if (EMO_CFG_LOAD_OBS_ENABLED == 1)
+  sint32 Load;
+  Load = (sint32)(((sint64)(Emo_Ctrl.CatchSpeed - Emo_Ctrl.ActSpeed) << 20) /
+                  ((sint64)Emo_LoadObs.Inertia * (Emo_Ctrl.CatchTime >> 1)));
+
+  if (Load > Emo_Ctrl.SpeedPi.PiMax)
+  {
+    Load = Emo_Ctrl.SpeedPi.PiMax;
+  }
+  else if (Load < Emo_Ctrl.SpeedPi.PiMin)
+  {
+    Load = Emo_Ctrl.SpeedPi.PiMin;
+  }
+  else
+  {
+    /* inside the limits */
+  }
+
+  return Load;
+#else
+  return 0;
+#endif
+} /* End of Emo_lCatchLoad */
+#endif
+
+
 /** \brief Stops the motor.
  *
  * \param None
@@ -162,7 +299,10 @@ uint32 Emo_StopMotor(void)
 {
   if ((Emo_Status.MotorState != EMO_MOTOR_STATE_RUN) &&
       ((Emo_Status.MotorState != EMO_MOTOR_STATE_START) &&
-       (Emo_Status.MotorState != EMO_MOTOR_STATE_FAULT)))
+       (Emo_Status.MotorState != EMO_MOTOR_STATE_FAULT) &&
+       (Emo_Status.MotorState != EMO_MOTOR_STATE_IDENT) &&
+       (Emo_Status.MotorState != EMO_MOTOR_STATE_IPD) &&
+       (Emo_Status.MotorState != EMO_MOTOR_STATE_CATCH)))
   {
     /* Error detected: return with error */
     return EMO_ERROR_MOTOR_NOT_STARTED;
@@ -170,14 +310,146 @@ uint32 Emo_StopMotor(void)
 
   /* Disable bridge */
   BDRV_Set_Bridge(Ch_Off, Ch_Off, Ch_Off, Ch_Off, Ch_Off, Ch_Off);
-  /* Stop PWM */
-  CCU6_StopTmr_T12();
+#if (EMO_CFG_REC_ENABLED == 1)
+
+  if ((Emo_Rec.Triggered == 1u) && (Emo_Rec.Remaining != 0u))
+  {
+    /* fault: PWM keeps running with the bridge off until the flight **
+    ** recorder has its post-trigger periods, see Emo_HandleFoc      */
+    Emo_Rec.StopPending = 1u;
+  }
+  else
+  {
+    /* explicit stop, no further periods: freeze flight recorder */
+    Emo_RecFreeze(EMO_REC_CAUSE_STOP);
+    Emo_lStopPwm();
+  }
+
+#else
+  Emo_lStopPwm();
+#endif
   /* Set stop state */
   Emo_Status.MotorState = EMO_MOTOR_STATE_STOP;
   /* Return without error */
   return EMO_ERROR_NONE;
 } /* End of Emo_StopMotor */
 
+/** \brief Stops the PWM after the bridge has been disabled.
+ *
+ * \param None
+ * \return None
+ *
+ * \note Called by Emo_StopMotor, or by Emo_HandleFoc when the post-trigger
+ * periods of the flight recorder are complete.
+ *
+ * \ingroup emo_api
+ */
+void Emo_lStopPwm(void)
+{
+  /* Stop PWM */
+  CCU6_StopTmr_T12();
+#if (EMO_CFG_CSA_OFFS_BACKGROUND == 1)
+  /* track the current sense offset while stopped */
+  Emo_lCsaOffsStart();
+#endif
+} /* End of Emo_lStopPwm */
+
+/** \brief CCU6 trap interrupt, the PWM outputs are already passive.
+ *
+ * Trap sources are the CTRAP pin and the software trap set by the bridge
+ * driver diagnosis. Only bookkeeping is left to do here.
+ * isr.c clears the trap flag after this callback, so the trap state is
+ * left at the next T12 zero match while the PWM of the flight recorder
+ * still runs; the bridge is off by Emo_StopMotor. The trap interrupt is
+ * disabled until Emo_StartMotor, an active trap pin does not re-enter.
+ * The callback is registered in the Config Wizard (CCU6_TRAP_CALLBACK),
+ * therefore it exists also with EMO_CFG_CTRAP_ENABLED = 0. Then the trap
+ * interrupt is not enabled by Emo_Init and a trap only stops the motor.
+ *
+ * \param None
+ * \return None
+ */
+void Emo_HandleTrap(void)
+{
+#if (EMO_CFG_CTRAP_ENABLED == 1)
+  Emo_Status.TrapCount++;
+  CCU6_TRAP_Int_Dis();
+#endif
+#if (EMO_CFG_REC_ENABLED == 1)
+  Emo_RecTrigger(EMO_REC_CAUSE_TRAP);
+#endif
+  (void)Emo_StopMotor();
+} /* End of Emo_HandleTrap */
+
+#if (EMO_CFG_RUNTIME_MEAS_ENABLED == 1)
+/** \brief Resets the runtime measurement of all handlers.
+ *
+ * \param None
+ * \return None
+ *
+ * \ingroup emo_api
+ */
+void Emo_RtReset(void)
+{
+  uint32 i;
+
+  for (i = 0u; i < EMO_RT_NUM; i++)
+  {
+    __disable_irq();
+    Emo_RtMeas[i].Calls = 0u;
+    Emo_RtMeas[i].CyclesLast = 0u;
+    Emo_RtMeas[i].CyclesMax = 0u;
+    Emo_RtMeas[i].CyclesSum = 0u;
+    __enable_irq();
+  }
+} /* End of Emo_RtReset */
+#endif
+
+#if (EMO_CFG_JITTER_MON_ENABLED == 1)
+/** \brief Resets the timing monitor of the PWM update.
+ *
+ * \param None
+ * \return None
+ *
+ * \ingroup emo_api
+ */
+void Emo_JitReset(void)
+{
+  __disable_irq();
+  Emo_JitMon.Periods = 0u;
+  Emo_JitMon.Deferred = 0u;
+  Emo_JitMon.Direct = 0u;
+  Emo_JitMon.Critical = 0u;
+  Emo_JitMon.Missed = 0u;
+  Emo_JitMon.Overrun = 0u;
+  Emo_JitMon.EndLast = 0u;
+  Emo_JitMon.EndMax = 0u;
+  Emo_JitMon.MarginMin = 0xFFFFu;
+  __enable_irq();
+} /* End of Emo_JitReset */
+#endif
+
+#if (EMO_CFG_SAT_COUNT_ENABLED == 1)
+/** \brief Resets the saturation counters of all call sites.
+ *
+ * \param None
+ * \return None
+ *
+ * \ingroup emo_api
+ */
+void Emo_SatReset(void)
+{
+  uint32 i;
+
+  for (i = 0u; i < EMO_SAT_NUM; i++)
+  {
+    __disable_irq();
+    Emo_SatCount[i] = 0u;
+    __enable_irq();
+  }
+} /* End of Emo_SatReset */
+#endif
+
 void Emo_lInitFocPar(void)
 {
   /* set to 15V */
@@ -199,6 +471,20 @@ void Emo_lInitFocPar(void)
   Emo_Svm.MaxAmp4164pr = (13643 * Emo_Svm.MaxAmp) >> MAT_FIX_SHIFT;
   Emo_Svm.MaxAmpQuadrat = (uint32)Emo_Svm.MaxAmp * Emo_Svm.MaxAmp;
   Emo_Svm.Kfact256 = 8388608 / Emo_Svm.MaxAmp; //2 exp23/MaxAmp
+#if (EMO_CFG_SVM_OVERMOD == 1)
+  /* overmodulation: six-step fundamental 2*sqrt(3)/pi * MaxAmp, region II **
+  ** from the fundamental of the hexagon trajectory of the edge projection **
+  ** 1.0548 * MaxAmp, vertex radius 2/sqrt(3) * MaxAmp                     */
+  Emo_Svm.MaxAmpOvm = (uint16)(1.10266 * Emo_Svm.MaxAmp);
+  Emo_Svm.OvmAmp2 = (uint16)(1.05482 * Emo_Svm.MaxAmp);
+  Emo_Svm.OvmAmpVertex = (uint16)(1.15470 * Emo_Svm.MaxAmp);
+  /* 8 table steps over each region */
+  Emo_Svm.OvmGain1 = (uint32)(8.0 * 256.0 * 65536.0 / (Emo_Svm.OvmAmp2 - Emo_Svm.MaxAmp));
+  Emo_Svm.OvmGain2 = (uint32)(8.0 * 256.0 * 65536.0 / (Emo_Svm.MaxAmpOvm - Emo_Svm.OvmAmp2));
+  Emo_Svm.MaxAmpFw = (uint16)(EMO_SVM_OVM_FW_REF * Emo_Svm.MaxAmpOvm);
+  Emo_Svm.MeasSkip = 0u;
+  Emo_Svm.StoredMeasSkip1 = 0u;
+#endif
   OpGain = 10.0;
   CSA_Set_Gain(0u);
   /* 1.25 => 125mV, secured OpAmp differential input voltage range */
@@ -258,21 +544,31 @@ void Emo_lInitFocPar(void)
 
   i = CSA_Offset;
 
-  if (i > 1800)
+  if (i > EMO_CSA_OFFS_MAX)
   {
-    i = 1800;
+    i = EMO_CSA_OFFS_MAX;
     Emo_Status.MotorStartError = Emo_Status.MotorStartError | EMO_ERROR_CSAOFFSET;
   }
 
-  if (i < 1500)
+  if (i < EMO_CSA_OFFS_MIN)
   {
-    i = 1500;
+    i = EMO_CSA_OFFS_MIN;
     Emo_Status.MotorStartError = Emo_Status.MotorStartError | EMO_ERROR_CSAOFFSET;
   }
 
   Emo_Svm.CsaOffset = i;
+#if (EMO_CFG_CSA_OFFS_BACKGROUND == 1)
+  /* the tracking filter starts at the measured offset */
+  Emo_Svm.CsaOffsetFilt = (uint32)i << 8u;
+  Emo_Svm.CsaOffsetCount = 1u;
+  Emo_lCsaOffsStart();
+#endif
   /* Initialize parameters for FOC */
   x = 32768.0 * KI * Emo_Focpar_Cfg.PhaseRes / KU;
+#if (EMO_CFG_IDENT_ENABLED == 1)
+  Emo_Ident.PhaseResNom = (uint32)x;
+  Emo_Ident.PhaseResAct = (uint32)x;
+#endif
 
   if (x > 32767.0)
   {
@@ -281,6 +577,10 @@ void Emo_lInitFocPar(void)
 
   Emo_Foc.PhaseRes = (uint16)x;
   x = 32768.0 * KI * Emo_Focpar_Cfg.PhaseInd / KPSIE;
+#if (EMO_CFG_IDENT_ENABLED == 1)
+  Emo_Ident.PhaseIndNom = (uint32)x;
+  Emo_Ident.PhaseIndAct = (uint32)x;
+#endif
 
   if (x > 32767.0)
   {
@@ -307,6 +607,22 @@ void Emo_lInitFocPar(void)
   }
 
   Emo_Foc.StartCurrent = (sint16)x;
+#if (EMO_CFG_IPD_ENABLED == 1)
+  /* position detection pulse: current rise of start current, U = L * I / t */
+  x = 32768.0 * Emo_Focpar_Cfg.PhaseInd * Emo_Focpar_Cfg.StartCurrent * CCU6_T12_FREQ / (EMO_IPD_PULSE_TIME * KU);
+
+  if (x > 16384)
+  {
+    x = 16384;
+  }
+
+  if (x < 1)
+  {
+    x = 1;
+  }
+
+  Emo_Ipd.Volt = (sint16)x;
+#endif
   x = Emo_Focpar_Cfg.TimeSpeedzero * SCU_FSYS / ((GPT12E_T2) * 4.0);
 
   if (x > 32767)
@@ -322,6 +638,28 @@ void Emo_lInitFocPar(void)
   }
 
   Emo_Foc.TimeSpeedzero = (uint16)x;
+  Emo_Ctrl.CatchTime = (uint16)(EMO_CATCH_TIME * SCU_FSYS / ((GPT12E_T2) * 4.0));
+  Emo_Ctrl.CatchDetect = Emo_Ctrl.CatchTime - (uint16)(EMO_CATCH_DETECT_TIME * SCU_FSYS / ((GPT12E_T2) * 4.0));
+#if (EMO_CFG_TRAJ_ENABLED == 1)
+  /* trajectory limits per T2 period */
+  x = EMO_TRAJ_ACCEL_MAX * (GPT12E_T2) * 4.0 / SCU_FSYS * (1uL << EMO_TRAJ_SHIFT);
+
+  if (x < 1)
+  {
+    x = 1;
+  }
+
+  Emo_Ctrl.TrajAccelMax = (sint32)x;
+  x = EMO_TRAJ_JERK_MAX * (GPT12E_T2) * 4.0 / SCU_FSYS * (GPT12E_T2) * 4.0 / SCU_FSYS * (1uL << EMO_TRAJ_SHIFT);
+
+  if (x < 1)
+  {
+    x = 1;
+  }
+
+  Emo_Ctrl.TrajJerk = (sint32)x;
+  Emo_Ctrl.TrajInit = 0u;
+#endif
   Emo_Foc.StartEndSpeed = (sint16)Emo_Focpar_Cfg.StartSpeedEnd;
   x = ((GPT12E_T2) * 4.0) / SCU_FSYS * Emo_Focpar_Cfg.StartSpeedSlewRate * 65536.0;
 
@@ -347,9 +685,62 @@ void Emo_lInitFocPar(void)
   Emo_Foc.RealFluxLp.CoefB = Emo_Foc.LpCoefb1;
   Emo_Foc.ImagFluxLp.CoefB = Emo_Foc.LpCoefb1;
   Emo_Ctrl.SpeedPi.Kp = Emo_Focpar_Cfg.SpeedPi_Kp;
+#if (EMO_CFG_SAT_COUNT_ENABLED == 1)
+  Emo_Ctrl.SpeedPi.SatSite = EMO_SAT_PI_SPEED;
+#endif
   Emo_Ctrl.SpeedPi.Ki = Emo_Focpar_Cfg.SpeedPi_Ki;
   Emo_Ctrl.SpeedPi.PiMin = (sint16)(32767.0 * Emo_Focpar_Cfg.MinRefStartCurr / KI);
   Emo_Ctrl.SpeedPi.PiMax = (sint16)(32767.0 * Emo_Focpar_Cfg.MaxRefStartCurr / KI);
+#if (EMO_CFG_SPEED_SCHED_ENABLED == 1)
+  Emo_Ctrl.SpeedPi.Ks = EMO_SPEED_SCHED_KS;
+
+  for (i = 0; i < EMO_SPEED_SCHED_POINTS; i++)
+  {
+    Emo_Ctrl.SchedSpeed[i] = (sint16)Emo_SpeedSched_Cfg[i].Speed;
+    Emo_Ctrl.SchedKp[i] = (sint16)Emo_SpeedSched_Cfg[i].SpeedPi_Kp;
+    Emo_Ctrl.SchedKi[i] = (sint16)Emo_SpeedSched_Cfg[i].SpeedPi_Ki;
+    x = 32767.0 * Emo_SpeedSched_Cfg[i].MaxRefCurr / KI;
+
+    if (x > 32767)
+    {
+      x = 32767;
+      Emo_Status.MotorStartError = Emo_Status.MotorStartError | EMO_ERROR_REFCURRENT;
+    }
+
+    Emo_Ctrl.SchedMax[i] = (sint16)x;
+    x = 32767.0 * Emo_SpeedSched_Cfg[i].MinRefCurr / KI;
+
+    if (x < -32767)
+    {
+      x = -32767;
+      Emo_Status.MotorStartError = Emo_Status.MotorStartError | EMO_ERROR_REFCURRENT;
+    }
+
+    Emo_Ctrl.SchedMin[i] = (sint16)x;
+  }
+
+  for (i = 0; i < (EMO_SPEED_SCHED_POINTS - 1u); i++)
+  {
+    x = Emo_SpeedSched_Cfg[i + 1u].Speed - Emo_SpeedSched_Cfg[i].Speed;
+
+    if (x < 1)
+    {
+      x = 1;
+      Emo_Status.MotorStartError = Emo_Status.MotorStartError | EMO_ERROR_SPEED_POINTS;
+    }
+
+    Emo_Ctrl.SchedGain[i] = (uint32)(16777216.0 / x);
+  }
+
+  x = EMO_SPEED_SCHED_LIM_SLEW * (GPT12E_T2) * 4.0 / SCU_FSYS * 32767.0 / KI;
+
+  if (x < 1)
+  {
+    x = 1;
+  }
+
+  Emo_Ctrl.SchedLimSlew = (sint16)x;
+#endif
   x = 32767.0 * Emo_Focpar_Cfg.MaxRefCurr / KI;
 
   if (x > 32767)
@@ -420,6 +811,52 @@ void Emo_lInitFocPar(void)
     Emo_Status.MotorStartError = Emo_Status.MotorStartError | EMO_ERROR_LIMITS_REFCURRENT;
   }
 
+#if (EMO_CFG_LOAD_OBS_ENABLED == 1)
+  /* acceleration per T2 period and q-current unit *2^20 */
+  x = EMO_LOBS_ACCEL * (GPT12E_T2) * 4.0 / SCU_FSYS * KI / 32768.0 * 1048576.0;
+
+  if (x > 65535)
+  {
+    x = 65535;
+  }
+
+  if (x < 1)
+  {
+    x = 1;
+  }
+
+  Emo_LoadObs.InertiaNom = (uint32)x;
+  Emo_LoadObs.Inertia = (uint32)x;
+  Emo_LoadObs.LoadGain = (1uL << (20u + EMO_LOBS_SHIFT - EMO_LOBS_BW_SHIFT)) / Emo_LoadObs.Inertia;
+  Emo_LoadObs.IdUpdates = 0u;
+#endif
+#if (EMO_CFG_FIELD_WEAK_ENABLED == 1)
+  /* field weakening PI: d-current between -EMO_FW_ID_MAX * MaxRefCurrent and 0 */
+  Emo_Ctrl.FwPi.Kp = EMO_FW_KP;
+  Emo_Ctrl.FwPi.Ki = EMO_FW_KI;
+  Emo_Ctrl.FwPi.IMin = (sint16)(-EMO_FW_ID_MAX * Emo_Ctrl.MaxRefCurrent);
+  Emo_Ctrl.FwPi.IMax = 0;
+  Emo_Ctrl.FwPi.PiMin = Emo_Ctrl.FwPi.IMin;
+  Emo_Ctrl.FwPi.PiMax = 0;
+#if (EMO_CFG_SAT_COUNT_ENABLED == 1)
+  Emo_Ctrl.FwPi.SatSite = EMO_SAT_PI_FW;
+#endif
+#endif
+#if (EMO_CFG_DT_COMP_ENABLED == 1)
+  /* deadtime compensation: band in phase current units (StatCurr / 4), **
+  ** one compare tick is sqrt(3) / EMO_CFG_FOC_TABLE_SCALE amplitude    */
+  x = EMO_DTC_CURR_BAND / KI * 32767.0 / 4.0;
+
+  if (x < 1)
+  {
+    x = 1;
+  }
+
+  Emo_Svm.DtcBand = (sint16)x;
+  Emo_Svm.DtcGain = (sint32)(EMO_DTC_TICKS / 2.0 * 16.0 * 32768.0 / x);
+  Emo_Svm.DtcKa = (uint16)(4096.0 / (1.7320508 * EMO_CFG_FOC_TABLE_SCALE));
+  Emo_Svm.DtcKb = (uint16)(4096.0 / EMO_CFG_FOC_TABLE_SCALE);
+#endif
   x = Emo_Focpar_Cfg.AdjustmCurrentControl;
 
   if ((x > 1) || (x < 0.01))
@@ -457,11 +894,22 @@ void Emo_lInitFocPar(void)
   }
 
   Emo_Ctrl.RealCurrPi.Ki = (sint16)x;
+#if (EMO_CFG_IDENT_ENABLED == 1)
+  /* current regulator gains expressed by PhaseInd and PhaseRes: **
+  ** Kp = AdjustmCurrentControl * 128 / CoAFlux * PhaseInd       **
+  ** Ki = AdjustmCurrentControl / 4 * PhaseRes                   */
+  Emo_Ident.KpFactor = (uint16)(Emo_Focpar_Cfg.AdjustmCurrentControl * 128.0 / CoAFlux * 4096.0);
+  Emo_Ident.KiFactor = (uint16)(Emo_Focpar_Cfg.AdjustmCurrentControl / 4.0 * 4096.0);
+#endif
   /* id = PI regulator limits */
   Emo_Ctrl.RealCurrPi.IMin = -28272;
   Emo_Ctrl.RealCurrPi.IMax = 28272;
   Emo_Ctrl.RealCurrPi.PiMin = -28272;
   Emo_Ctrl.RealCurrPi.PiMax = 28272;
+#if (EMO_CFG_SAT_COUNT_ENABLED == 1)
+  Emo_Ctrl.RealCurrPi.SatSite = EMO_SAT_PI_CURR_REAL;
+  Emo_Ctrl.ImagCurrPi.SatSite = EMO_SAT_PI_CURR_IMAG;
+#endif
   Emo_Ctrl.ImagCurrPi.Kp =  Emo_Ctrl.RealCurrPi.Kp;
   Emo_Ctrl.ImagCurrPi.Ki =  Emo_Ctrl.RealCurrPi.Ki;
   /* iq = PI regulator limits, iq needs higher range than id */
@@ -491,7 +939,11 @@ void Emo_lInitFocPar(void)
   Emo_Ctrl.FluxbtrLp.CoefB = 1000;
   Emo_Ctrl.SpeedLpdisplay.CoefA = 1000;
   Emo_Ctrl.SpeedLpdisplay.CoefB = 1000;
-  Emo_Ctrl.Pllkp = 100;
+#if (EMO_CFG_DCLINK_FAST == 1)
+  Emo_Foc.DcLinkLp.CoefA = (sint16)(32768.0 / (Emo_Focpar_Cfg.PWM_Frequency * EMO_DCLINK_LP_TIME));
+  Emo_Foc.DcLinkLp.CoefB = Emo_Foc.DcLinkLp.CoefA;
+#endif
+  Emo_Ctrl.Pllkp = Emo_Focpar_Cfg.PllKp;
   x = 60.0 * Emo_Focpar_Cfg.PWM_Frequency / 64.0;
 
   if (x > 32767.0)
@@ -546,6 +998,115 @@ void Emo_lInitFocPar(void)
   }
 } /* End of Emo_lInitFocPar */
 
+#if (EMO_CFG_CSA_OFFS_BACKGROUND == 1)
+/** \brief Starts the background measurement of the current sense offset.
+ *
+ * The ADC exceptional sequence converts the CSA channel on the GPT12E T3
+ * output instead of the T13 compare, no interrupt, the result is read by
+ * Emo_lCsaOffsTrack. T3 runs free at fSYS/4, T3OTL toggles at every
+ * overflow (6.5ms), so a conversion is triggered every 13.1ms. T3 is
+ * stopped again by Emo_StartMotor.
+ *
+ * \param None
+ * \return None
+ */
+void Emo_lCsaOffsStart(void)
+{
+  ADC1->IE.bit.ESM_IE = 0;
+  GPT12E_T3_Mode_Timer_Sel();
+  GPT12E_T3_Mode_Timer_Clk_Prescaler_Sel(0u);
+  GPT12E_T3_Start();
+  ADC1_ESM_Trigger_Select(ADC1_Trigg_GPT12E_T3);
+} /* End of Emo_lCsaOffsStart */
+
+
+/** \brief Tracks the current sense offset in stop state, called from the
+ *  T2 overflow handler, a new sample arrives about every 7th call.
+ *
+ * \param None
+ * \return None
+ */
+void Emo_lCsaOffsTrack(void)
+{
+  uint32 Res;
+  uint32 Sample;
+  Res = ADC1->RES_OUT1.reg;
+
+  if ((Res & ADC1_RES_OUT1_VF1_Msk) == 0u)
+  {
+    return;
+  }
+
+  Sample = Res & ADC1_RES_OUT1_OUT_CH1_Msk;
+  CSA_Offset = (uint16)Sample;
+
+  if (Emo_Svm.CsaOffsetCount == 0u)
+  {
+    Emo_Svm.CsaOffsetFilt = Sample << 8u;
+  }
+  else
+  {
+    /* slow low pass, follows temperature drift */
+    Emo_Svm.CsaOffsetFilt = (Emo_Svm.CsaOffsetFilt - (Emo_Svm.CsaOffsetFilt >> EMO_CSA_OFFS_SHIFT)) +
+                            ((Sample << 8u) >> EMO_CSA_OFFS_SHIFT);
+  }
+
+  if (Emo_Svm.CsaOffsetCount < 0xFFFFu)
+  {
+    Emo_Svm.CsaOffsetCount++;
+  }
+
+  Sample = Emo_Svm.CsaOffsetFilt >> 8u;
+
+  if (Sample > EMO_CSA_OFFS_MAX)
+  {
+    Sample = EMO_CSA_OFFS_MAX;
+    Emo_Status.MotorStartError = Emo_Status.MotorStartError | EMO_ERROR_CSAOFFSET;
+  }
+
+  if (Sample < EMO_CSA_OFFS_MIN)
+  {
+    Sample = EMO_CSA_OFFS_MIN;
+    Emo_Status.MotorStartError = Emo_Status.MotorStartError | EMO_ERROR_CSAOFFSET;
+  }
+
+  Emo_Svm.CsaOffset = (uint16)Sample;
+} /* End of Emo_lCsaOffsTrack */
+#endif
+
+
+/** \brief Checks if the start can be handed over to closed loop before
+ *  the start end speed is reached.
+ *
+ * \param None
+ * \return 1 if the flux estimator is locked long enough
+ */
+uint32 Emo_lHandoverReady(void)
+{
+  uint32 Ready;
+#if (EMO_CFG_HANDOVER_ENABLED == 1)
+  sint32 Slope;
+#endif
+  Ready = 0u;
+#if (EMO_CFG_HANDOVER_ENABLED == 1)
+  Slope = Emo_Foc.StartSpeedSlope;
+
+  if (Slope < 0)
+  {
+    Slope = -Slope;
+  }
+
+  if ((Emo_Ctrl.HandoverConf >= EMO_HANDOVER_CONF) &&
+      (Slope >= (Emo_Foc.StartEndSpeed >> EMO_HANDOVER_SPEED_SHIFT)))
+  {
+    Ready = 1u;
+  }
+
+#endif
+  return Ready;
+} /* End of Emo_lHandoverReady */
+
+
 void Emo_lInitFocVar(void)
 {
   uint16 i;
@@ -582,6 +1143,12 @@ void Emo_lInitFocVar(void)
   Emo_Ctrl.RealCurrPi.IOut = 0;
   Emo_Ctrl.ImagCurrPi.IOut = 0;
   Emo_Ctrl.SpeedLp.Out = 0;
+#if (EMO_CFG_SPEED_SCHED_ENABLED == 1)
+  /* limits of the first schedule point at entry of RUN */
+  Emo_Ctrl.SpeedPi.Dout = 0;
+  Emo_Ctrl.SpeedPi.PiMax = Emo_Ctrl.SchedMax[0];
+  Emo_Ctrl.SpeedPi.PiMin = Emo_Ctrl.SchedMin[0];
+#endif
   Emo_Foc.StartSpeedSlopeMem = 0;
   Emo_Foc.CountStart = Emo_Foc.TimeSpeedzero;
   /* define 30 as start angle */
@@ -594,9 +1161,669 @@ void Emo_lInitFocVar(void)
 
   Emo_Ctrl.SpeedLpdisplay.Out = 0;
   Emo_Ctrl.SpeedLp.Out = 0;
-  Emo_Svm.CounterOffsetAdw = 0;
+  Emo_Ctrl.HandoverCheck = 0u;
+  Emo_Ctrl.HandoverStep = 0;
+#if (EMO_CFG_HANDOVER_ENABLED == 1)
+  Emo_Ctrl.HandoverConf = 0u;
+  Emo_Ctrl.HandoverStart = 0u;
+  Emo_Ctrl.AngleOffset = 0;
+#endif
+#if (EMO_CFG_FIELD_WEAK_ENABLED == 1)
+  Emo_Ctrl.FwPi.IOut = 0;
+  Emo_Ctrl.RefCurrReal = 0;
+#endif
+#if (EMO_CFG_LOAD_OBS_ENABLED == 1)
+  Emo_LoadObs.Init = 0u;
+#endif
+#if (EMO_CFG_DCLINK_FAST == 1)
+  /* start the DC-link filter at the actual voltage */
+  Emo_Foc.DcLinkLp.Out = (sint32)ADC1->RES_OUT6.reg << 15u;
+  Emo_DcLinkUpdate();
+#endif
   Emo_Svm.CsaOffsetAdwSumme = 0;
-} /* End of Emo_lInitFocVar */
+#if (EMO_CFG_CSA_OFFS_BACKGROUND == 1)
+
+  if (Emo_Svm.CsaOffsetCount >= EMO_CSA_OFFS_VALID)
+  {
+    /* offset tracked during stop: voltage from the first period on */
+    Emo_Svm.CsaOffsetAdw = Emo_Svm.CsaOffset;
+    Emo_Svm.CounterOffsetAdw = 128;
+  }
+  else
+  {
+    Emo_Svm.CounterOffsetAdw = 0;
+  }
+
+#else
+  Emo_Svm.CounterOffsetAdw = 0;
+#endif
+} /* End of Emo_lInitFocVar */
+
+#if (EMO_CFG_IDENT_ENABLED == 1)
+void Emo_lInitIdentVar(void)
+{
+  Emo_Ident.Phase = EMO_IDENT_PHASE_DC1;
+  Emo_Ident.Count = 0;
+  Emo_Ident.Repeat = 0;
+  Emo_Ident.RefCurr = Emo_Foc.StartCurrent >> 1;
+  Emo_Ident.VoltSum = 0;
+  Emo_Ident.CurrSum = 0;
+  Emo_Ident.StepDeltaSum = 0;
+  Emo_Ident.StepCurrSum = 0;
+} /* End of Emo_lInitIdentVar */
+
+/** \brief Evaluates the parameter identification.
+ *
+ * PhaseRes = 32768 * (U2 - U1) / (I2 - I1)
+ * PhaseInd = CoAFlux * PhaseRes * (I2 - Imean) * STEP_TIME / dI
+ * The step voltage is the regulator output at I2, so the inductance voltage
+ * is PhaseRes * (I2 - Imean); the deadtime and switch voltage offset in U2
+ * cancels out.
+ * The results are checked against the configured values (factor 4),
+ * on success the flux estimator and current regulator are updated,
+ * otherwise the configured values are kept and EMO_ERROR_IDENT is set.
+ *
+ * \param None
+ * \return None
+ *
+ * \ingroup emo_api
+ */
+void Emo_lEvalIdent(void)
+{
+  sint32 du;
+  sint32 di;
+  sint32 imean;
+  uint32 res;
+  uint32 ind;
+  Emo_Ident.Done = 1u;
+  du = Emo_Ident.Volt2 - Emo_Ident.Volt1;
+  di = Emo_Ident.Curr2 - Emo_Ident.Curr1;
+
+  if ((du <= 0) || (di <= 0) || (Emo_Ident.StepDeltaSum <= 0))
+  {
+    Emo_Status.MotorStartError = Emo_Status.MotorStartError | EMO_ERROR_IDENT;
+    return;
+  }
+
+  res = ((uint32)du << MAT_FIX_SHIFT) / (uint32)di;
+  /* mean current during the steps */
+  imean = Emo_Ident.StepCurrSum >> (EMO_IDENT_STEP_SHIFT + 1);
+  /* voltage across inductance, without the offset contained in Volt2 */
+  du = (sint32)(((sint64)(Emo_Ident.Curr2 - imean) * res) >> MAT_FIX_SHIFT);
+
+  if (du <= 0)
+  {
+    Emo_Status.MotorStartError = Emo_Status.MotorStartError | EMO_ERROR_IDENT;
+    return;
+  }
+
+  ind = (uint32)((((uint64)du * (uint16)Emo_Foc.RealFluxLp.CoefA * EMO_IDENT_STEP_TIME) << EMO_IDENT_STEP_SHIFT) / (uint32)Emo_Ident.StepDeltaSum);
+
+  if ((res < (Emo_Ident.PhaseResNom >> 2)) || (res > (Emo_Ident.PhaseResNom << 2)) ||
+      (ind < (Emo_Ident.PhaseIndNom >> 2)) || (ind > (Emo_Ident.PhaseIndNom << 2)))
+  {
+    Emo_Status.MotorStartError = Emo_Status.MotorStartError | EMO_ERROR_IDENT;
+    return;
+  }
+
+  Emo_SetPhasePar(res, ind);
+} /* End of Emo_lEvalIdent */
+
+
+/** \brief Sets phase resistance and inductance of the motor model.
+ *
+ * Updates the flux estimator and the current regulator gains.
+ *
+ * \param Res Phase resistance, 32768 * KI * R / KU
+ * \param Ind Phase inductance, 32768 * KI * L / KPSIE
+ * \return None
+ *
+ * \note Service should only be called when motor is stopped.
+ *
+ * \ingroup emo_api
+ */
+void Emo_SetPhasePar(uint32 Res, uint32 Ind)
+{
+  uint32 x;
+  Emo_Ident.PhaseResAct = Res;
+  Emo_Ident.PhaseIndAct = Ind;
+  /* Flux estimator */
+  Emo_Foc.PhaseRes = (Res > 32767u) ? 32767u : (uint16)Res;
+  Emo_Foc.PhaseInd = (Ind > 32767u) ? 32767u : (uint16)Ind;
+  /* Current regulator */
+  x = (Ind * Emo_Ident.KpFactor) >> 12;
+
+  if (x > 32767u)
+  {
+    x = 32767u;
+  }
+
+  if (x < 1u)
+  {
+    x = 1u;
+  }
+
+  Emo_Ctrl.RealCurrPi.Kp = (sint16)x;
+  Emo_Ctrl.ImagCurrPi.Kp = (sint16)x;
+  x = (Res * Emo_Ident.KiFactor) >> 12;
+
+  if (x > 32767u)
+  {
+    x = 32767u;
+  }
+
+  if (x < 1u)
+  {
+    x = 1u;
+  }
+
+  Emo_Ctrl.RealCurrPi.Ki = (sint16)x;
+  Emo_Ctrl.ImagCurrPi.Ki = (sint16)x;
+} /* End of Emo_SetPhasePar */
+
+
+/** \brief Requests a new parameter identification at the next start.
+ *
+ * Used when the stored parameters are outdated, e.g. after a motor
+ * exchange or when the winding temperature differs strongly.
+ *
+ * \param None
+ * \return None
+ *
+ * \ingroup emo_api
+ */
+void Emo_RequestIdent(void)
+{
+  Emo_Ident.Done = 0u;
+} /* End of Emo_RequestIdent */
+#endif
+
+#if (EMO_CFG_IPD_ENABLED == 1)
+void Emo_lInitIpdVar(void)
+{
+  uint16 i;
+  Emo_Ipd.Index = 0;
+  Emo_Ipd.Count = 0;
+  Emo_Ipd.Done = 0u;
+
+  for (i = 0; i < EMO_IPD_PULSES; i++)
+  {
+    Emo_Ipd.Peak[i] = 0;
+  }
+} /* End of Emo_lInitIpdVar */
+
+/** \brief Evaluates the initial position detection.
+ *
+ * The pulse with the highest peak current gives the north pole, the angle
+ * is refined by a parabola through the peaks of the neighbouring pulses.
+ * The start angle is set 90deg ahead (current in the real axis of the I/F
+ * start) and the alignment time is skipped. Without a clear difference to
+ * the opposite pulse, or with too little current, the alignment at the
+ * configured start angle is kept and EMO_ERROR_IPD is set.
+ *
+ * \param None
+ * \return None
+ *
+ * \note Emo_lInitFocVar has to be called before.
+ *
+ * \ingroup emo_api
+ */
+void Emo_lEvalIpd(void)
+{
+  uint16 i;
+  uint16 m;
+  sint32 PeakMax;
+  sint32 a;
+  sint32 c;
+  sint32 den;
+  sint32 Offset;
+  m = 0u;
+  PeakMax = Emo_Ipd.Peak[0u];
+
+  for (i = 1u; i < EMO_IPD_PULSES; i++)
+  {
+    if (Emo_Ipd.Peak[i] > PeakMax)
+    {
+      PeakMax = Emo_Ipd.Peak[i];
+      m = i;
+    }
+  }
+
+  /* opposite pulse: difference by saturation gives the polarity */
+  c = Emo_Ipd.Peak[(m + (EMO_IPD_PULSES / 2u)) % EMO_IPD_PULSES];
+
+  if ((PeakMax < (Emo_Foc.StartCurrent >> 2)) || ((PeakMax - c) < (PeakMax >> EMO_IPD_POL_SHIFT)))
+  {
+    Emo_Status.MotorStartError = Emo_Status.MotorStartError | EMO_ERROR_IPD;
+    return;
+  }
+
+  a = Emo_Ipd.Peak[(m + EMO_IPD_PULSES - 1u) % EMO_IPD_PULSES];
+  c = Emo_Ipd.Peak[(m + 1u) % EMO_IPD_PULSES];
+  /* vertex of the parabola, within +-half a step */
+  den = a - (2 * PeakMax) + c;
+  Offset = 0;
+
+  if (den < 0)
+  {
+    Offset = ((a - c) * (sint32)EMO_IPD_STEP) / (2 * den);
+  }
+
+  Emo_Ipd.Angle = (uint16)(((sint32)m * (sint32)EMO_IPD_STEP) + Offset);
+  Emo_Foc.StartAngle = Emo_Ipd.Angle + 16384u;
+  Emo_Foc.CountStart = 0;
+} /* End of Emo_lEvalIpd */
+#endif
+
+
+#if (EMO_CFG_LOAD_OBS_ENABLED == 1)
+/** \brief Executes the load observer.
+ *
+ * Reduced order observer of the load current iL (load torque and friction
+ * in q-current units) out of the speed w and the q-current iq, with the
+ * model w(k+1) = w(k) + Inertia * (iq(k) - iL):
+ * iL = Z - LoadGain * w, Z(k+1) = Z(k) + 2^-BW_SHIFT * (iq(k) - iL(k))
+ * The load current is added to the output of the speed regulator, the
+ * speed regulator only has to correct the model error.
+ * Inertia is identified from the changes of acceleration and q-current:
+ * dA(k) = Inertia * dIq(k-1), least squares over 2^EMO_LOBS_ID_SHIFT
+ * samples with sufficient current change.
+ *
+ * \param None
+ * \return None
+ *
+ * \note Service is called after the speed regulator in state RUN.
+ *
+ * \ingroup emo_api
+ */
+void Emo_lLoadObs(void)
+{
+  sint32 Iq;
+  sint32 Accel;
+  sint32 dA;
+  sint32 dI;
+  sint32 Ref;
+  sint64 Inertia;
+  Iq = Emo_Ctrl.RotCurrImagdisplay;
+
+  if (Emo_LoadObs.Init == 0u)
+  {
+    /* take over the load from the speed regulator at entry of RUN */
+    Emo_LoadObs.LoadCurr = (Emo_Ctrl.SpeedPi.IOut >> 15) << EMO_LOBS_SHIFT;
+    Emo_Ctrl.SpeedPi.IOut = 0;
+    Emo_LoadObs.Z = Emo_LoadObs.LoadCurr + (sint32)((sint64)Emo_Ctrl.ActSpeed * Emo_LoadObs.LoadGain);
+    Emo_LoadObs.LastSpeed = Emo_Ctrl.ActSpeed;
+    Emo_LoadObs.LastAccel = 0;
+    Emo_LoadObs.LastIq = (sint16)Iq;
+    Emo_LoadObs.LastIq2 = (sint16)Iq;
+    Emo_LoadObs.IdSxy = 0;
+    Emo_LoadObs.IdSxx = 0;
+    Emo_LoadObs.IdCount = 0u;
+    Emo_LoadObs.Init = 1u;
+  }
+  else
+  {
+    /* observer */
+    Emo_LoadObs.LoadCurr = Emo_LoadObs.Z - (sint32)((sint64)Emo_Ctrl.ActSpeed * Emo_LoadObs.LoadGain);
+    Emo_LoadObs.Z += ((Iq << EMO_LOBS_SHIFT) - Emo_LoadObs.LoadCurr) >> EMO_LOBS_BW_SHIFT;
+    /* inertia identification */
+    Accel = Emo_Ctrl.ActSpeed - Emo_LoadObs.LastSpeed;
+    dA = Accel - Emo_LoadObs.LastAccel;
+    dI = Emo_LoadObs.LastIq - Emo_LoadObs.LastIq2;
+
+    if ((dI >= EMO_LOBS_ID_MIN_DI) || (dI <= -EMO_LOBS_ID_MIN_DI))
+    {
+      Emo_LoadObs.IdSxy += (sint64)dA * dI;
+      Emo_LoadObs.IdSxx += (sint64)dI * dI;
+      Emo_LoadObs.IdCount++;
+    }
+
+    if (Emo_LoadObs.IdCount == (1u << EMO_LOBS_ID_SHIFT))
+    {
+      Inertia = (Emo_LoadObs.IdSxy << 20) / Emo_LoadObs.IdSxx;
+
+      if ((Inertia >= (sint64)(Emo_LoadObs.InertiaNom >> 2)) && (Inertia <= (sint64)(Emo_LoadObs.InertiaNom << 2)))
+      {
+        /* filtered update, observer state adapted for a continuous load current */
+        Emo_LoadObs.Inertia = ((Emo_LoadObs.Inertia * 3u) + (uint32)Inertia) >> 2;
+        Emo_LoadObs.LoadGain = (1uL << (20u + EMO_LOBS_SHIFT - EMO_LOBS_BW_SHIFT)) / Emo_LoadObs.Inertia;
+        Emo_LoadObs.Z = Emo_LoadObs.LoadCurr + (sint32)((sint64)Emo_Ctrl.ActSpeed * Emo_LoadObs.LoadGain);
+        Emo_LoadObs.IdUpdates++;
+      }
+
+      Emo_LoadObs.IdSxy = 0;
+      Emo_LoadObs.IdSxx = 0;
+      Emo_LoadObs.IdCount = 0u;
+    }
+
+    Emo_LoadObs.LastSpeed = Emo_Ctrl.ActSpeed;
+    Emo_LoadObs.LastAccel = (sint16)Accel;
+    Emo_LoadObs.LastIq2 = Emo_LoadObs.LastIq;
+    Emo_LoadObs.LastIq = (sint16)Iq;
+  }
+
+  /* feed-forward, limited like the speed regulator output */
+  Ref = Emo_Ctrl.RefCurr + (Emo_LoadObs.LoadCurr >> EMO_LOBS_SHIFT);
+
+  if (Ref > Emo_Ctrl.SpeedPi.PiMax)
+  {
+    Ref = Emo_Ctrl.SpeedPi.PiMax;
+  }
+  else if (Ref < Emo_Ctrl.SpeedPi.PiMin)
+  {
+    Ref = Emo_Ctrl.SpeedPi.PiMin;
+  }
+  else
+  {
+    /* inside the limits */
+  }
+
+  Emo_Ctrl.RefCurr = (sint16)Ref;
+} /* End of Emo_lLoadObs */
+#endif
+
+
+#if (EMO_CFG_TRAJ_ENABLED == 1)
+/** \brief Executes the speed trajectory.
+ *
+ * The reference speed follows the commanded speed with acceleration
+ * limited to TrajAccelMax and its change limited to TrajJerk per T2
+ * period. The acceleration is reduced in time, when the remaining speed
+ * difference reaches the speed change needed to bring the acceleration
+ * back to 0: Accel * |Accel| / (2 * Jerk) + Accel / 2.
+ * At entry of RUN the trajectory starts at the actual speed.
+ *
+ * \param None
+ * \return None
+ *
+ * \note Service is called before the speed regulator in state RUN.
+ *
+ * \ingroup emo_api
+ */
+void Emo_lTraj(void)
+{
+  sint32 Err;
+  sint32 Dist;
+  sint32 Accel;
+  sint32 AbsAccel;
+  sint32 Jerk;
+
+  if (Emo_Ctrl.TrajInit == 0u)
+  {
+    Emo_Ctrl.TrajSpeed = (sint32)Emo_Ctrl.ActSpeed << EMO_TRAJ_SHIFT;
+    Emo_Ctrl.TrajAccel = 0;
+    Emo_Ctrl.TrajInit = 1u;
+  }
+
+  Accel = Emo_Ctrl.TrajAccel;
+  Jerk = Emo_Ctrl.TrajJerk;
+  AbsAccel = Accel;
+
+  if (AbsAccel < 0)
+  {
+    AbsAccel = -AbsAccel;
+  }
+
+  Err = ((sint32)Emo_Ctrl.CmdSpeed << EMO_TRAJ_SHIFT) - Emo_Ctrl.TrajSpeed;
+  /* speed change until the acceleration is 0 again */
+  Dist = (sint32)(((sint64)Accel * AbsAccel) / (2 * Jerk)) + (Accel / 2);
+
+  if ((Err <= (AbsAccel + Jerk)) && (Err >= -(AbsAccel + Jerk)) && (AbsAccel <= Jerk))
+  {
+    /* target reached */
+    Emo_Ctrl.TrajSpeed = (sint32)Emo_Ctrl.CmdSpeed << EMO_TRAJ_SHIFT;
+    Accel = 0;
+  }
+  else
+  {
+    if (Err > Dist)
+    {
+      Accel += Jerk;
+
+      if (Accel > Emo_Ctrl.TrajAccelMax)
+      {
+        Accel = Emo_Ctrl.TrajAccelMax;
+      }
+    }
+    else if (Err < Dist)
+    {
+      Accel -= Jerk;
+
+      if (Accel < -Emo_Ctrl.TrajAccelMax)
+      {
+        Accel = -Emo_Ctrl.TrajAccelMax;
+      }
+    }
+    else
+    {
+      /* keep acceleration */
+    }
+
+    Emo_Ctrl.TrajSpeed += Accel;
+  }
+
+  Emo_Ctrl.TrajAccel = Accel;
+  Emo_Ctrl.RefSpeed = (sint16)(Emo_Ctrl.TrajSpeed >> EMO_TRAJ_SHIFT);
+} /* End of Emo_lTraj */
+
+#if (EMO_CFG_LOAD_OBS_ENABLED == 1)
+/** \brief Adds the acceleration of the trajectory as q-current.
+ *
+ * q-current = TrajAccel / Inertia of the load observer, the reference
+ * current stays inside the limits of the speed regulator.
+ *
+ * \param None
+ * \return None
+ *
+ * \ingroup emo_api
+ */
+void Emo_lTrajFf(void)
+{
+  sint32 Ref;
+  Ref = Emo_Ctrl.RefCurr + ((Emo_Ctrl.TrajAccel << (20u - EMO_TRAJ_SHIFT)) / (sint32)Emo_LoadObs.Inertia);
+
+  if (Ref > Emo_Ctrl.SpeedPi.PiMax)
+  {
+    Ref = Emo_Ctrl.SpeedPi.PiMax;
+  }
+  else if (Ref < Emo_Ctrl.SpeedPi.PiMin)
+  {
+    Ref = Emo_Ctrl.SpeedPi.PiMin;
+  }
+  else
+  {
+    /* inside the limits */
+  }
+
+  Emo_Ctrl.RefCurr = (sint16)Ref;
+} /* End of Emo_lTrajFf */
+#endif
+#endif
+
+
+#if (EMO_CFG_SPEED_SCHED_ENABLED == 1)
+/** \brief Schedules gains and current limits of the speed regulator.
+ *
+ * Kp, Ki and the current limits are interpolated linearly between the
+ * points of Emo_SpeedSched_Cfg over the absolute actual speed, outside the
+ * table the first or last point is used. For negative speed motoring and
+ * braking limits are mirrored.
+ * Bumpless: the change of the P part by a new Kp is moved into the I
+ * output, the limits follow with SchedLimSlew per T2 period.
+ *
+ * \param None
+ * \return None
+ *
+ * \note Service is called before the speed regulator in state RUN.
+ *
+ * \ingroup emo_api
+ */
+void Emo_lSpeedSched(void)
+{
+  sint32 Speed;
+  sint32 Frac;
+  sint32 Kp;
+  sint32 Max;
+  sint32 Min;
+  sint32 Lim;
+  sint32 Err;
+  uint16 i;
+  Speed = Emo_Ctrl.ActSpeed;
+
+  if (Speed < 0)
+  {
+    Speed = -Speed;
+  }
+
+  i = 0u;
+
+  while ((i < (EMO_SPEED_SCHED_POINTS - 2u)) && (Speed >= Emo_Ctrl.SchedSpeed[i + 1u]))
+  {
+    i++;
+  }
+
+  /* position between point i and i + 1, 0..4096 */
+  if (Speed <= Emo_Ctrl.SchedSpeed[i])
+  {
+    Frac = 0;
+  }
+  else
+  {
+    Frac = (sint32)(((uint32)(Speed - Emo_Ctrl.SchedSpeed[i]) * Emo_Ctrl.SchedGain[i]) >> 12);
+
+    if (Frac > 4096)
+    {
+      Frac = 4096;
+    }
+  }
+
+  Kp = Emo_Ctrl.SchedKp[i] + (((Emo_Ctrl.SchedKp[i + 1u] - Emo_Ctrl.SchedKp[i]) * Frac) >> 12);
+  /* bumpless: output of the P part unchanged, saturated as in Mat_ExePi_Windup */
+  Err = (sint16)(Emo_Ctrl.RefSpeed - Emo_Ctrl.ActSpeed);
+  Lim = __SSAT(Err * (sint32)Emo_Ctrl.SpeedPi.Kp, 31u - 6u) - __SSAT(Err * Kp, 31u - 6u);
+  Emo_Ctrl.SpeedPi.IOut += Mat_SsatCnt(Lim, 31u - 6u, EMO_SAT_SPEED_SCHED) << 6u;
+  Emo_Ctrl.SpeedPi.Kp = (sint16)Kp;
+  Emo_Ctrl.SpeedPi.Ki = (sint16)(Emo_Ctrl.SchedKi[i] + (((Emo_Ctrl.SchedKi[i + 1u] - Emo_Ctrl.SchedKi[i]) * Frac) >> 12));
+  Max = Emo_Ctrl.SchedMax[i] + (((Emo_Ctrl.SchedMax[i + 1u] - Emo_Ctrl.SchedMax[i]) * Frac) >> 12);
+  Min = Emo_Ctrl.SchedMin[i] + (((Emo_Ctrl.SchedMin[i + 1u] - Emo_Ctrl.SchedMin[i]) * Frac) >> 12);
+
+  if (Emo_Ctrl.ActSpeed < 0)
+  {
+    Lim = Max;
+    Max = -Min;
+    Min = -Lim;
+  }
+
+  /* bumpless: limits with slew rate */
+  Lim = Emo_Ctrl.SpeedPi.PiMax;
+
+  if (Max > (Lim + Emo_Ctrl.SchedLimSlew))
+  {
+    Max = Lim + Emo_Ctrl.SchedLimSlew;
+  }
+  else if (Max < (Lim - Emo_Ctrl.SchedLimSlew))
+  {
+    Max = Lim - Emo_Ctrl.SchedLimSlew;
+  }
+  else
+  {
+    /* limit reached */
+  }
+
+  Lim = Emo_Ctrl.SpeedPi.PiMin;
+
+  if (Min > (Lim + Emo_Ctrl.SchedLimSlew))
+  {
+    Min = Lim + Emo_Ctrl.SchedLimSlew;
+  }
+  else if (Min < (Lim - Emo_Ctrl.SchedLimSlew))
+  {
+    Min = Lim - Emo_Ctrl.SchedLimSlew;
+  }
+  else
+  {
+    /* limit reached */
+  }
+
+  Emo_Ctrl.SpeedPi.PiMax = (sint16)Max;
+  Emo_Ctrl.SpeedPi.IMax = (sint16)Max;
+  Emo_Ctrl.SpeedPi.PiMin = (sint16)Min;
+  Emo_Ctrl.SpeedPi.IMin = (sint16)Min;
+} /* End of Emo_lSpeedSched */
+#endif
+
+
+#if (EMO_CFG_FIELD_WEAK_ENABLED == 1)
+/** \brief Executes the field weakening.
+ *
+ * The voltage amplitude of the SVM is regulated to MaxAmp9091pr (MaxAmpFw
+ * with overmodulation) by a negative d-current reference, which is 0 as
+ * long as the amplitude stays below. The q-current reference and the speed
+ * regulator I output are limited to sqrt(MaxRefCurrent^2 - Id^2).
+ *
+ * \param None
+ * \return None
+ *
+ * \note Service is called after the speed regulator in state RUN.
+ *
+ * \ingroup emo_api
+ */
+void Emo_lFieldWeak(void)
+{
+  uint32 Index;
+  sint32 IqMax;
+  sint32 AmpRef;
+#if (EMO_CFG_SVM_OVERMOD == 1)
+  AmpRef = Emo_Svm.MaxAmpFw;
+#else
+  AmpRef = Emo_Svm.MaxAmp9091pr;
+#endif
+  /* amplitude above the reference drives the d-current negative */
+  Emo_Ctrl.RefCurrReal = Mat_ExePi(&Emo_Ctrl.FwPi, (sint16)(AmpRef - (sint32)Emo_Svm.Amp));
+
+  if (Emo_Ctrl.MaxRefCurrent <= 0)
+  {
+    return;
+  }
+
+  /* q-current on the current circle: MaxRefCurrent * sqrt(1 - (Id / MaxRefCurrent)^2) */
+  Index = ((uint32)(-Emo_Ctrl.RefCurrReal) << 8) / (uint32)Emo_Ctrl.MaxRefCurrent;
+
+  if (Index > 256u)
+  {
+    Index = 256u;
+  }
+
+  IqMax = ((sint32)Table_sqrtmqu[Index] * Emo_Ctrl.MaxRefCurrent) >> 8;
+
+  if (Emo_Ctrl.RefCurr > IqMax)
+  {
+    Emo_Ctrl.RefCurr = (sint16)IqMax;
+  }
+  else if (Emo_Ctrl.RefCurr < -IqMax)
+  {
+    Emo_Ctrl.RefCurr = (sint16)(-IqMax);
+  }
+  else
+  {
+    /* inside the circle */
+  }
+
+  /* no windup of the speed regulator outside the circle */
+  if (Emo_Ctrl.SpeedPi.IOut > (IqMax << 15))
+  {
+    Emo_Ctrl.SpeedPi.IOut = IqMax << 15;
+  }
+  else if (Emo_Ctrl.SpeedPi.IOut < -(IqMax << 15))
+  {
+    Emo_Ctrl.SpeedPi.IOut = -(IqMax << 15);
+  }
+  else
+  {
+    /* inside the circle */
+  }
+} /* End of Emo_lFieldWeak */
+#endif
 
 
 /** \brief Handles T2 overflow.
@@ -608,6 +1835,17 @@ void Emo_lInitFocVar(void)
  */
 void Emo_HandleT2Overflow(void)
 {
+#if (EMO_CFG_TRAJ_ENABLED == 1)
+
+  if (Emo_Status.MotorState != EMO_MOTOR_STATE_RUN)
+  {
+    /* start-up: commanded speed directly, trajectory begins in RUN */
+    Emo_Ctrl.RefSpeed = Emo_Ctrl.CmdSpeed;
+    Emo_Ctrl.TrajInit = 0u;
+  }
+
+#endif
+
   if (Emo_Status.MotorState == EMO_MOTOR_STATE_START)
   {
     /* Open loop: */
@@ -621,16 +1859,22 @@ void Emo_HandleT2Overflow(void)
         /* apply start up ramp */
         Emo_Foc.StartSpeedSlope = Mat_Ramp(Emo_Foc.StartEndSpeed, Emo_Foc.StartSpeedSlewRate, &Emo_Foc.StartSpeedSlopeMem);
         /* calculate frequency out of ramp */
-        Emo_Foc.StartFrequencySlope = __SSAT(Mat_FixMulScale(Emo_Foc.StartSpeedSlope, Emo_Foc.SpeedtoFrequency, 0), MAT_FIX_SAT);
+        Emo_Foc.StartFrequencySlope = Mat_SsatCnt(Mat_FixMulScale(Emo_Foc.StartSpeedSlope, Emo_Foc.SpeedtoFrequency, 0), MAT_FIX_SAT, EMO_SAT_START);
 
-        if (Emo_Foc.StartSpeedSlope == Emo_Foc.StartEndSpeed)
+        if ((Emo_Foc.StartSpeedSlope == Emo_Foc.StartEndSpeed) || (Emo_lHandoverReady() == 1u))
         {
-          /* end speed reached */
+          /* end speed reached or estimator locked */
 #if (EMO_RUN==1)
+#if (EMO_CFG_HANDOVER_ENABLED == 1)
+          Emo_Ctrl.HandoverStart = 1u;
+#endif
           Emo_Status.MotorState = EMO_MOTOR_STATE_RUN;                       /*Start Foc */
 #endif
-          /* preload speed regulator */
-          Emo_Ctrl.SpeedPi.IOut = Emo_Ctrl.RefCurr << 14;
+          /* preload speed regulator with the signed start current, which **
+          ** becomes the q-current: reference continuous at handover      */
+          Emo_Ctrl.SpeedPi.IOut = (sint32)Emo_Ctrl.RefCurr << 15;
+          Emo_Ctrl.HandoverStep = Emo_Ctrl.RefCurr;
+          Emo_Ctrl.HandoverCheck = 1u;
         }
       }
       else
@@ -639,14 +1883,19 @@ void Emo_HandleT2Overflow(void)
         /* apply start up ramp */
         Emo_Foc.StartSpeedSlope = Mat_Ramp(-Emo_Foc.StartEndSpeed, Emo_Foc.StartSpeedSlewRate, &Emo_Foc.StartSpeedSlopeMem);
         /* calculate frequency out of ramp */
-        Emo_Foc.StartFrequencySlope = __SSAT(Mat_FixMulScale(Emo_Foc.StartSpeedSlope, Emo_Foc.SpeedtoFrequency, 0), MAT_FIX_SAT);
+        Emo_Foc.StartFrequencySlope = Mat_SsatCnt(Mat_FixMulScale(Emo_Foc.StartSpeedSlope, Emo_Foc.SpeedtoFrequency, 0), MAT_FIX_SAT, EMO_SAT_START);
 
-        if (Emo_Foc.StartSpeedSlope == -Emo_Foc.StartEndSpeed)
+        if ((Emo_Foc.StartSpeedSlope == -Emo_Foc.StartEndSpeed) || (Emo_lHandoverReady() == 1u))
         {
 #if (EMO_RUN==1)
+#if (EMO_CFG_HANDOVER_ENABLED == 1)
+          Emo_Ctrl.HandoverStart = 1u;
+#endif
           Emo_Status.MotorState = EMO_MOTOR_STATE_RUN;                       /*Start Foc */
 #endif
-          Emo_Ctrl.SpeedPi.IOut = Emo_Ctrl.RefCurr << 14;
+          Emo_Ctrl.SpeedPi.IOut = (sint32)Emo_Ctrl.RefCurr << 15;
+          Emo_Ctrl.HandoverStep = Emo_Ctrl.RefCurr;
+          Emo_Ctrl.HandoverCheck = 1u;
         }
       }
     }
@@ -669,6 +1918,7 @@ void Emo_HandleT2Overflow(void)
   }
   else if (Emo_Status.MotorState == EMO_MOTOR_STATE_RUN)
   {
+#if (EMO_CFG_SPEED_SCHED_ENABLED == 0)
     /* switch speed regulator current limits based on speed */
     if (Emo_Ctrl.ActSpeed > Emo_Ctrl.Speedlevelmaxstart)
     {
@@ -691,11 +1941,116 @@ void Emo_HandleT2Overflow(void)
       }
     }
 
+#endif
+#if (EMO_CFG_TRAJ_ENABLED == 1)
+    /* reference speed from the trajectory */
+    Emo_lTraj();
+#endif
+#if (EMO_CFG_SPEED_SCHED_ENABLED == 1)
+    /* gains and current limits over speed */
+    Emo_lSpeedSched();
+    /* Speed Regulator: Execute PI algorithm with anti-windup for (imaginary) reference current */
+    Emo_Ctrl.RefCurr = Mat_ExePi_Windup(&Emo_Ctrl.SpeedPi, Emo_Ctrl.RefSpeed - Emo_Ctrl.ActSpeed);
+#else
     /* Speed Regulator: Execute PI algorithm for (imaginary) reference current */
     Emo_Ctrl.RefCurr = Mat_ExePi(&Emo_Ctrl.SpeedPi, Emo_Ctrl.RefSpeed - Emo_Ctrl.ActSpeed);
+#endif
+#if (EMO_CFG_LOAD_OBS_ENABLED == 1)
+    /* load current feed-forward */
+    Emo_lLoadObs();
+#if (EMO_CFG_TRAJ_ENABLED == 1)
+    /* acceleration feed-forward */
+    Emo_lTrajFf();
+#endif
+#endif
+#if (EMO_CFG_FIELD_WEAK_ENABLED == 1)
+    /* d-current reference and current circle limitation */
+    Emo_lFieldWeak();
+#endif
+
+    if (Emo_Ctrl.HandoverCheck == 1u)
+    {
+      /* continuity check: step of the q-current reference in the first **
+      ** closed loop period, only the proportional part should remain  */
+      Emo_Ctrl.HandoverCheck = 0u;
+      Emo_Ctrl.HandoverStep = Emo_Ctrl.RefCurr - Emo_Ctrl.HandoverStep;
+    }
+
     /* Actual Speed Filter */
     Emo_Ctrl.ActSpeeddisplay = Mat_ExeLp_without_min_max(&Emo_Ctrl.SpeedLpdisplay, Emo_Ctrl.ActSpeed);
   }
+#if (EMO_CFG_IDENT_ENABLED == 1)
+  else if (Emo_Status.MotorState == EMO_MOTOR_STATE_IDENT)
+  {
+    if (Emo_Ident.Phase == EMO_IDENT_PHASE_DONE)
+    {
+      /* calculate and apply R and L, continue with normal start */
+      Emo_lEvalIdent();
+      Emo_lInitFocVar();
+      Emo_lSetStartState();
+    }
+  }
+#endif
+#if (EMO_CFG_IPD_ENABLED == 1)
+  else if (Emo_Status.MotorState == EMO_MOTOR_STATE_IPD)
+  {
+    if (Emo_Ipd.Done == 1u)
+    {
+      /* start at the detected position, CSA offset of the pulses is kept */
+      Emo_lInitFocVar();
+      Emo_Svm.CounterOffsetAdw = 128;
+      Emo_lEvalIpd();
+      Emo_Status.MotorState = EMO_MOTOR_STATE_START;
+    }
+  }
+#endif
+#if (EMO_CFG_CATCH_ENABLED == 1)
+  else if (Emo_Status.MotorState == EMO_MOTOR_STATE_CATCH)
+  {
+    /* zero current regulation in Emo_HandleFoc (RefCurr=0), flux estimator, **
+    ** angle buffer and PLL follow the back-EMF of a rotating motor          */
+    Emo_Ctrl.ActSpeeddisplay = Mat_ExeLp_without_min_max(&Emo_Ctrl.SpeedLpdisplay, Emo_Ctrl.ActSpeed);
+
+    if (Emo_Ctrl.CatchCount > 0)
+    {
+      Emo_Ctrl.CatchCount--;
+
+      if ((Emo_Ctrl.CatchCount == Emo_Ctrl.CatchDetect) && ((Emo_Ctrl.FluxbtrLp.Out >> 15) <= EMO_CATCH_MIN_FLUX))
+      {
+        /* no back-EMF after the estimator settled: standstill, start now */
+        Emo_Ctrl.CatchCount = 0;
+      }
+      else if (Emo_Ctrl.CatchCount == (Emo_Ctrl.CatchTime >> 1))
+      {
+        /* reference for the load estimation */
+        Emo_Ctrl.CatchSpeed = Emo_Ctrl.ActSpeed;
+      }
+      else
+      {
+        /* observation continues */
+      }
+    }
+    else
+    {
+      if (((Emo_Ctrl.FluxbtrLp.Out >> 15) > EMO_CATCH_MIN_FLUX) &&
+          (((Emo_Ctrl.RefSpeed > 0) && (Emo_Ctrl.ActSpeed > Emo_Ctrl.SpeedLevelSwitchOn)) ||
+           ((Emo_Ctrl.RefSpeed < 0) && (Emo_Ctrl.ActSpeed < -Emo_Ctrl.SpeedLevelSwitchOn))))
+      {
+        /* motor rotates in reference direction above switch on speed: **
+        ** continue in closed loop, speed regulator starts with the     **
+        ** load current estimated from the coasting deceleration        */
+        Emo_Ctrl.SpeedPi.IOut = Emo_lCatchLoad() << 15;
+        Emo_Status.MotorState = EMO_MOTOR_STATE_RUN;
+      }
+      else
+      {
+        /* standstill, too slow or wrong direction: normal start */
+        Emo_lInitFocVar();
+        Emo_lSetStartState();
+      }
+    }
+  }
+#endif
   else
   {
     Emo_StopMotor();
@@ -705,13 +2060,25 @@ void Emo_HandleT2Overflow(void)
   {
     Emo_Ctrl.ActSpeed = Mat_ExeLp_without_min_max(&Emo_Ctrl.SpeedLp, 0);
     Emo_Ctrl.ActSpeeddisplay = Mat_ExeLp_without_min_max(&Emo_Ctrl.SpeedLpdisplay, Emo_Ctrl.ActSpeed);
+#if (EMO_CFG_CSA_OFFS_BACKGROUND == 1)
+
+    if (CCU6->TCTR0.bit.T12R == 0u)
+    {
+      /* PWM stopped, no post-trigger recording running */
+      Emo_lCsaOffsTrack();
+    }
+
+#endif
   }
 
+#if (EMO_CFG_DCLINK_FAST == 0)
   /* read DC-Link-Voltage */
   Emo_Foc.DcLinkVoltage = ADC1->RES_OUT6.reg;
   Emo_Foc.Dcfactor1 = Emo_Foc.Kdcdivident1 / Emo_Foc.DcLinkVoltage;
-  Emo_Foc.Dcfactor2 = __SSAT(Mat_FixMulScale(Emo_Foc.DcLinkVoltage, Emo_Foc.Kdcfactor2, 3), MAT_FIX_SAT);
-  Emo_Ctrl.ImagCurrPi.IMax = __SSAT(Mat_FixMulScale(Emo_Foc.DcLinkVoltage, Emo_Foc.Kdcfactoriqc, 5), MAT_FIX_SAT);
+  Emo_Foc.Dcfactor2 = Mat_SsatCnt(Mat_FixMulScale(Emo_Foc.DcLinkVoltage, Emo_Foc.Kdcfactor2, 3), MAT_FIX_SAT, EMO_SAT_DCFACTOR);
+#endif
+  /* DC-link voltage dependent current limit */
+  Emo_Ctrl.ImagCurrPi.IMax = Mat_SsatCnt(Mat_FixMulScale(Emo_Foc.DcLinkVoltage, Emo_Foc.Kdcfactoriqc, 5), MAT_FIX_SAT, EMO_SAT_IQ_MAX);
   Emo_Ctrl.ImagCurrPi.PiMax = Emo_Ctrl.ImagCurrPi.IMax;
   Emo_Ctrl.ImagCurrPi.IMin = -Emo_Ctrl.ImagCurrPi.IMax;
   Emo_Ctrl.ImagCurrPi.PiMin = Emo_Ctrl.ImagCurrPi.IMin;
@@ -719,7 +2086,7 @@ void Emo_HandleT2Overflow(void)
   if (Emo_Ctrl.EnableStartVoltage == 1)
   {
     /* correct Start Voltage based on currently measured DC-Link voltage */
-    Emo_Foc.StartVoltAmpDivUz = __SSAT(Mat_FixMulScale(Emo_Foc.StartVoltAmp, Emo_Foc.Dcfactor1, 1), MAT_FIX_SAT);
+    Emo_Foc.StartVoltAmpDivUz = Mat_SsatCnt(Mat_FixMulScale(Emo_Foc.StartVoltAmp, Emo_Foc.Dcfactor1, 1), MAT_FIX_SAT, EMO_SAT_START);
   }
 
   Emo_Ctrl.SpeedPi.IMin = Emo_Ctrl.SpeedPi.PiMin;
@@ -739,11 +2106,18 @@ void Emo_HandleT2Overflow(void)
 
 void GPT1_T2_Handler(void)
 {
+#if (EMO_CFG_RUNTIME_MEAS_ENABLED == 1)
+  uint32 RtStart;
+  RtStart = Emo_RtStart();
+#endif
   /* T2 overflow: */
   /* Set T2 to reload value */
   GPT12E->T2.reg += GPT12E_T2_TICK;
   /* Handle T2 overflow */
   Emo_HandleT2Overflow();
+#if (EMO_CFG_RUNTIME_MEAS_ENABLED == 1)
+  Emo_RtStop(EMO_RT_T2, RtStart);
+#endif
 } /* End of GPT1_IRQHandler */
 
 
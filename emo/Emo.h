@@ -51,10 +51,119 @@
 /*******************************************************************************
 **                   Global Macro Definitions to be changed                   **
 *******************************************************************************/
-/* CTRAP enable
+/* CTRAP enable: faults force the CCU6 trap state, all six PWM outputs go
+ * to passive level (bridge off) in hardware, the software stop afterwards
+ * is only bookkeeping; off until the trap to bridge off latency has been
+ * measured on the target
  * Range: 0=disabled, 1=enabled */
 #define EMO_CFG_CTRAP_ENABLED (0)
 
+/* CTRAP input pin, active low, e.g. output of an external shunt comparator
+ * Range: 0=no pin (software trap only), 1=CTRAP_0 (P2.4), 2=CTRAP_1 (P2.3) */
+#define EMO_CFG_CTRAP_PIN (0)
+
+/* Standstill identification of phase resistance and inductance,
+ * executed once per power-up before the first start
+ * Range: 0=disabled, 1=enabled */
+#define EMO_CFG_IDENT_ENABLED (0)
+
+/* Catch spin: a rotating motor is detected at start and taken over in
+ * closed loop without stopping it first
+ * Range: 0=disabled, 1=enabled */
+#define EMO_CFG_CATCH_ENABLED (0)
+
+/* Runtime measurement of the interrupt handlers with the SysTick counter:
+ * calls, last, max. and accumulated CPU cycles per handler; instrumentation
+ * only, every handler gets slower
+ * Range: 0=disabled, 1=enabled */
+#define EMO_CFG_RUNTIME_MEAS_ENABLED (0)
+
+/* Timing monitor of the PWM update: position of the T12 counter when the
+ * new compare values are loaded, deferred, critical and missed shadow
+ * transfers, to see the jitter margin of the FOC interrupt on the target;
+ * instrumentation only, adds cycles to the FOC interrupt
+ * Range: 0=disabled, 1=enabled */
+#define EMO_CFG_JITTER_MON_ENABLED (0)
+
+/* Saturation counters: every fixed-point saturation and PI limitation
+ * counts its events per call site in Emo_SatCount (EMO_SAT_x), exported
+ * with the flight recorder dump; instrumentation only, the FOC interrupt
+ * gets slower
+ * Range: 0=plain saturation, 1=counted */
+#define EMO_CFG_SAT_COUNT_ENABLED (0)
+
+/* Per-period CCU6 update with direct register stores instead of the SDK
+ * functions, no T13 period read for the ADC trigger compare value
+ * Range: 0=SDK functions, 1=direct stores */
+#define EMO_CFG_CCU6_FAST_UPDATE (1)
+
+/* DC-link voltage compensation every PWM period: voltage filtered in the
+ * FOC interrupt, Dcfactor1 by reciprocal without division
+ * Range: 0=every T2 overflow with division, 1=every PWM period */
+#define EMO_CFG_DCLINK_FAST (1)
+
+/* Current sense offset tracked in the background during stop (ADC ESM
+ * triggered by GPT12E T3), the motor is started without the offset
+ * estimation periods and Emo_Init does not wait for the ADC
+ * Range: 0=measured at init and at every start, 1=background */
+#define EMO_CFG_CSA_OFFS_BACKGROUND (0)
+
+/* Early handover from I/F start to closed loop as soon as the flux
+ * estimator is locked, angle and current controller state are blended
+ * Range: 0=at start end speed only, 1=estimator confidence */
+#define EMO_CFG_HANDOVER_ENABLED (0)
+
+/* Initial rotor position detection at standstill by voltage pulses
+ * (inductance saliency and saturation), the I/F start begins at the
+ * detected position without the alignment time
+ * Range: 0=alignment at start angle, 1=position detection */
+#define EMO_CFG_IPD_ENABLED (0)
+
+/* Field weakening in closed loop: negative d-current reference from the
+ * voltage amplitude above MaxAmp9091pr, q-current limited to the current
+ * circle of MaxRefCurrent, executed every T2 overflow
+ * Range: 0=disabled (d-current 0), 1=enabled */
+#define EMO_CFG_FIELD_WEAK_ENABLED (0)
+
+/* Overmodulation of the SVM beyond the inscribed circle up to six-step:
+ * region I by projection to the hexagon edge, region II by angle hold at
+ * the vertices, without division in the PWM interrupt. Current samples of
+ * patterns without measurement window are skipped.
+ * Range: 0=linear (Limitsvektor), 1=overmodulation */
+#define EMO_CFG_SVM_OVERMOD (0)
+
+/* Deadtime compensation: the compares are corrected per phase by the
+ * deadtime and switching delay in direction of the reference current, with
+ * a linear transition around zero current. The voltage error left over
+ * (clamped compares, reference to actual current) is added to the voltage
+ * of the flux estimator.
+ * Range: 0=no compensation, 1=compensation in START and RUN */
+#define EMO_CFG_DT_COMP_ENABLED (0)
+
+/* Load observer in closed loop: load current from speed and q-current,
+ * added to the speed regulator output as feed-forward, the acceleration
+ * per q-current (inertia) is identified during operation
+ * Range: 0=disabled, 1=enabled */
+#define EMO_CFG_LOAD_OBS_ENABLED (0)
+
+/* Speed trajectory in closed loop: the commanded speed is followed with
+ * limited acceleration and jerk (S-curve), with load observer enabled the
+ * acceleration is fed forward as q-current
+ * Range: 0=command is reference speed, 1=trajectory */
+#define EMO_CFG_TRAJ_ENABLED (0)
+
+/* Speed regulator with Kp, Ki and current limits interpolated over the
+ * speed (Emo_SpeedSched_Cfg), back-calculation anti-windup, bumpless gain
+ * and limit changes
+ * Range: 0=fixed gains, limits switched at the speed levels, 1=scheduled */
+#define EMO_CFG_SPEED_SCHED_ENABLED (0)
+
+/* Sine table: quarter wave with quadrant folding (257 entries) instead of
+ * full wave with cosine window (1280 entries), saves 2KB flash for a few
+ * cycles per sin/cos fetch, negative half wave may differ by 1 LSB
+ * Range: 0=full wave, 1=quarter wave */
+#define EMO_CFG_TABLE_QUARTERWAVE (0)
+
 /* Scaling constant for FOC sinus table */
 #define EMO_CFG_FOC_TABLE_SCALE (0.117553711)
 
@@ -70,17 +179,71 @@ typedef struct
 {
   uint8 MotorState;               /**< \brief Motor state */
   uint16 MotorStartError;         /**<\brief Start Error bits */
+#if (EMO_CFG_CTRAP_ENABLED == 1)
+  uint16 TrapCount;               /**< \brief Number of trap shutdowns */
+#endif
 } TEmo_Status;
 
 extern TEmo_Status Emo_Status;
 
+/* Saturation counter sites, PI controllers have 3 counters: I limit, **
+** P part, PI limit; not assigned PI controllers count to PI_OTHER    */
+#define EMO_SAT_PI_OTHER          (0u)
+#define EMO_SAT_PI_CURR_REAL      (3u)
+#define EMO_SAT_PI_CURR_IMAG      (6u)
+#define EMO_SAT_PI_SPEED          (9u)
+#define EMO_SAT_PI_FW             (12u)
+#define EMO_SAT_LP                (15u)
+#define EMO_SAT_CLARKE            (16u)
+#define EMO_SAT_PARK              (17u)
+#define EMO_SAT_INV_PARK          (18u)
+#define EMO_SAT_POLAR             (19u)
+#define EMO_SAT_DCLINK_VOLT       (20u)
+#define EMO_SAT_STAT_VOLT         (21u)
+#define EMO_SAT_DT_COMP           (22u)
+#define EMO_SAT_FLUX_VOLT         (23u)
+#define EMO_SAT_FLUX              (24u)
+#define EMO_SAT_FLUX_ABS          (25u)
+#define EMO_SAT_PLL               (26u)
+#define EMO_SAT_DECOUPLING        (27u)
+#define EMO_SAT_LIMIT_VECT        (28u)
+#define EMO_SAT_DCFACTOR          (29u)
+#define EMO_SAT_IQ_MAX            (30u)
+#define EMO_SAT_START             (31u)
+#define EMO_SAT_SPEED_SCHED       (32u)
+#define EMO_SAT_NUM               (33u)
+
+#if (EMO_CFG_SAT_COUNT_ENABLED == 1)
+  extern uint16 Emo_SatCount[EMO_SAT_NUM];
+#endif
+
 uint32 Emo_GetSpeed(void);
 uint32 Emo_Init(void);
 void Emo_SetRefSpeed(sint16 RefSpeed);
 uint32 Emo_StartMotor(uint32 EnableBridge);
+void Emo_SetPhasePar(uint32 Res, uint32 Ind);
+void Emo_RequestIdent(void);
+void Emo_RtReset(void);
+void Emo_JitReset(void);
+void Emo_SatReset(void);
 extern uint32 Emo_StopMotor(void);
 void Emo_lInitFocPar(void);
+void Emo_lStopPwm(void);
+void Emo_lCsaOffsStart(void);
+void Emo_lCsaOffsTrack(void);
+uint32 Emo_lHandoverReady(void);
 void Emo_lInitFocVar(void);
+void Emo_lInitIdentVar(void);
+void Emo_lSetStartState(void);
+sint32 Emo_lCatchLoad(void);
+void Emo_lEvalIdent(void);
+void Emo_lInitIpdVar(void);
+void Emo_lEvalIpd(void);
+void Emo_lFieldWeak(void);
+void Emo_lLoadObs(void);
+void Emo_lTraj(void);
+void Emo_lTrajFf(void);
+void Emo_lSpeedSched(void);
 __STATIC_INLINE uint32 Emo_GetMotorState(void);
 
 /** \brief Returns the motor state.
@@ -47,6 +47,7 @@
 *******************************************************************************/
 
 #include "Emo_RAM.h"
+#include "Emo_Rec.h"
 
 /*******************************************************************************
 **                        Private Function Declarations                       **
@@ -55,11 +56,35 @@
 __STATIC_INLINE void Emo_lEstFlux(void);
 __STATIC_INLINE void Emo_FluxAnglePll(void);
 __STATIC_INLINE void Emo_lExeSvm(TEmo_Svm *pSvm);
+#if (EMO_CFG_SVM_OVERMOD == 1)
+  __STATIC_INLINE uint32 Emo_lOvmTable(const uint16 *pTable, uint32 Amp, uint32 Base, uint32 Gain);
+  __STATIC_INLINE uint32 Emo_lOvmPrepare(TEmo_Svm *pSvm, uint32 *pIndex);
+  __STATIC_INLINE void Emo_lOvmProject(TEmo_Svm *pSvm, sint32 *pT1, sint32 *pT2);
+#endif
+#if (EMO_CFG_DT_COMP_ENABLED == 1)
+  __STATIC_INLINE void Emo_lDtComp(TEmo_Svm *pSvm);
+  __STATIC_INLINE sint32 Emo_lDtCompPhase(TEmo_Svm *pSvm, uint16 *pUp, uint16 *pDown, sint32 Ref, sint32 Act);
+#endif
+#if (EMO_CFG_HANDOVER_ENABLED == 1)
+  __STATIC_INLINE void Emo_lHandoverConf(void);
+  __STATIC_INLINE void Emo_lHandoverBlend(void);
+#endif
+#if (EMO_CFG_JITTER_MON_ENABLED == 1)
+  __STATIC_INLINE uint16 Emo_lJitPos(void);
+  __STATIC_INLINE void Emo_lJitUpdate(void);
+#endif
 
 #if (EMO_DECOUPLING==1)
   __STATIC_INLINE TComplex Emo_CurrentDecoupling(void);
 #endif
 
+#if (EMO_CFG_IDENT_ENABLED == 1)
+  __STATIC_INLINE void Emo_lExeIdent(void);
+#endif
+#if (EMO_CFG_IPD_ENABLED == 1)
+  __STATIC_INLINE void Emo_lExeIpd(void);
+#endif
+
 #define EMO_IMESS  1
 
 /*******************************************************************************
@@ -71,6 +96,24 @@ uint32 Emo_AdcResult[4u];
 TEmo_Ctrl Emo_Ctrl;
 TEmo_Foc Emo_Foc;
 TEmo_Svm Emo_Svm;
+#if (EMO_CFG_IDENT_ENABLED == 1)
+  TEmo_Ident Emo_Ident;
+#endif
+#if (EMO_CFG_IPD_ENABLED == 1)
+  TEmo_Ipd Emo_Ipd;
+#endif
+#if (EMO_CFG_LOAD_OBS_ENABLED == 1)
+  TEmo_LoadObs Emo_LoadObs;
+#endif
+#if (EMO_CFG_RUNTIME_MEAS_ENABLED == 1)
+  TEmo_RtMeas Emo_RtMeas[EMO_RT_NUM];
+#endif
+#if (EMO_CFG_JITTER_MON_ENABLED == 1)
+  TEmo_JitMon Emo_JitMon;
+#endif
+#if (EMO_CFG_SAT_COUNT_ENABLED == 1)
+  uint16 Emo_SatCount[EMO_SAT_NUM];
+#endif
 
 /*******************************************************************************
 **                         Global Function Definitions                        **
@@ -87,15 +130,20 @@ TEmo_Svm Emo_Svm;
  */
 void Emo_HandleAdc1(void)
 {
+#if (EMO_CFG_RUNTIME_MEAS_ENABLED == 1)
+  uint32 RtStart;
+  RtStart = Emo_RtStart();
+#endif
   /*prepare Timer13 for 2nd ADC measurement, **
   **values calculated in previous period     */
-  CCU6_SetT13Compare(Emo_Svm.CompT13ValueDown);
-  /* Set Timer13 Trigger calculated previous period pm*/
-  CCU6_SetT13Trigger(0x76);
+  Emo_PwmLoadT13Down();
   /*read ADC digital value and store in array*/
   Emo_AdcResult[0u] = ADC1->RES_OUT1.reg;
   /*disable ESM interrupt*/
   ADC1->IE.bit.ESM_IE = 0;
+#if (EMO_CFG_RUNTIME_MEAS_ENABLED == 1)
+  Emo_RtStop(EMO_RT_ADC1, RtStart);
+#endif
 }
 
 
@@ -120,6 +168,17 @@ void Emo_CurrAdc1(void)
   R1miR0 = AdcResult1 - AdcResult0;
   /* Calculate currents according to sector number */
   sector = Emo_Svm.StoredSector1;
+#if (EMO_CFG_SVM_OVERMOD == 1)
+
+  if (Emo_Svm.StoredMeasSkip1 != 0u)
+  {
+    /* pattern without measurement window: keep currents of last period */
+    Emo_Svm.StoredSector1 = Emo_Svm.Sector;
+    Emo_Svm.StoredMeasSkip1 = Emo_Svm.MeasSkip;
+    return;
+  }
+
+#endif
 
   switch (sector)
   {
@@ -168,6 +227,9 @@ void Emo_CurrAdc1(void)
     default:
     {
       /* unexpected error => halt motor, reset device */
+#if (EMO_CFG_REC_ENABLED == 1)
+      Emo_RecTrigger(EMO_REC_CAUSE_SECTOR);
+#endif
       Emo_StopMotor();
     }
     break;
@@ -175,21 +237,28 @@ void Emo_CurrAdc1(void)
 
   /*prepare sector number for next period*/
   Emo_Svm.StoredSector1 = Emo_Svm.Sector;
+#if (EMO_CFG_SVM_OVERMOD == 1)
+  Emo_Svm.StoredMeasSkip1 = Emo_Svm.MeasSkip;
+#endif
 } /* End of Emo_HandleAdc1 */
 
 
 void Emo_HandleCCU6ShadowTrans(void)
 {
-  CCU6_LoadShadowRegister_CC60(Emo_Svm.comp60up);
-  CCU6_LoadShadowRegister_CC61(Emo_Svm.comp61up);
-  CCU6_LoadShadowRegister_CC62(Emo_Svm.comp62up);
-  CCU6_EnableST_T12();
-  /* Set Timer13 Trigger calculated previous period zero-match*/
-  CCU6_SetT13Trigger(0x7a);
-  /* Set T13 Compare Value */
-  CCU6_SetT13Compare(Emo_Svm.CompT13ValueUp);
+#if (EMO_CFG_RUNTIME_MEAS_ENABLED == 1)
+  uint32 RtStart;
+  RtStart = Emo_RtStart();
+#endif
+  /* compare values, T13 trigger and compare value for up-counting part */
+  Emo_PwmLoadUp();
   /*disable Timer12 PM Interrupt*/
   CCU6->IEN.bit.ENT12PM = 0;
+#if (EMO_CFG_JITTER_MON_ENABLED == 1)
+  Emo_JitMon.Pending = 0u;
+#endif
+#if (EMO_CFG_RUNTIME_MEAS_ENABLED == 1)
+  Emo_RtStop(EMO_RT_SHADOW, RtStart);
+#endif
 }
 
 void Emo_HandleFoc(void)
@@ -198,9 +267,31 @@ void Emo_HandleFoc(void)
   uint16 ampl;
   uint16 i;
   TComplex Vect1 = {0, 0};
+#if (EMO_CFG_SVM_OVERMOD == 0)
   TComplex Vect2;
+#endif
   sint16 Speed;
   sint32 jj;
+#if (EMO_CFG_RUNTIME_MEAS_ENABLED == 1)
+  uint32 RtStart;
+#if (EMO_CFG_REC_ENABLED == 1)
+  uint32 RtRecStart;
+#endif
+  RtStart = Emo_RtStart();
+#endif
+#if (EMO_CFG_JITTER_MON_ENABLED == 1)
+  Emo_JitMon.StartPos = Emo_lJitPos();
+  /* a one match from now on belongs to the next period */
+  CCU6_T12_OM_Int_Clr();
+
+  if (Emo_JitMon.Pending == 1u)
+  {
+    /* period match interrupt of the last period did not load the values */
+    Emo_JitMon.Missed++;
+    Emo_JitMon.Pending = 0u;
+  }
+
+#endif
   Emo_AdcResult[2u] = Emo_AdcResult[0u];
   /* Enable ADC Interrupt */
   ADC1->ICLR.bit.ESM_ICLR = 1;
@@ -208,15 +299,37 @@ void Emo_HandleFoc(void)
   /*get 2nd ADC measurement from previous period*/
   Emo_AdcResult[1u] = ADC1->RES_OUT1.reg;
   /*set PWM compare values for T12 down-counting part*/
-  CCU6_LoadShadowRegister_CC60(Emo_Svm.comp60down);
-  CCU6_LoadShadowRegister_CC61(Emo_Svm.comp61down);
-  CCU6_LoadShadowRegister_CC62(Emo_Svm.comp62down);
-  CCU6_EnableST_T12();
+  Emo_PwmLoadDown();
+#if (EMO_CFG_DCLINK_FAST == 1)
+  /* DC-link voltage compensation */
+  Emo_DcLinkUpdate();
+#endif
   Emo_CurrAdc1();
   /* Perform Clarke transformation to stationary 2-phase system */
   Emo_Foc.StatCurr = Mat_Clarke(Emo_Svm.PhaseCurr);
   /* Perform Park transformation to rotating 2-phase system */
   Emo_Foc.RotCurr = Mat_Park(Emo_Foc.StatCurr, Emo_Foc.Angle);
+#if (EMO_CFG_REC_ENABLED == 1)
+
+  if (Emo_Status.MotorState == EMO_MOTOR_STATE_STOP)
+  {
+    /* stopped by a fault, bridge off: record the post-trigger periods, **
+    ** then stop the PWM once                                           */
+    if (Emo_Rec.StopPending == 1u)
+    {
+      Emo_RecCapture();
+
+      if (Emo_Rec.Remaining == 0u)
+      {
+        Emo_Rec.StopPending = 0u;
+        Emo_lStopPwm();
+      }
+    }
+
+    return;
+  }
+
+#endif
   /* Estimate flux and calculate rotor angle */
   Emo_lEstFlux();
 
@@ -248,6 +361,9 @@ void Emo_HandleFoc(void)
     /* Filter speed */
     Emo_Ctrl.ActSpeed = Mat_ExeLp_without_min_max(&Emo_Ctrl.SpeedLp, Speed);
     Emo_FluxAnglePll();
+#if (EMO_CFG_HANDOVER_ENABLED == 1)
+    Emo_lHandoverConf();
+#endif
 
     if (Emo_Ctrl.RefSpeed > 0)
     {
@@ -264,9 +380,23 @@ void Emo_HandleFoc(void)
     /* iq */
     Emo_Foc.RotVolt.Imag = Mat_ExePi(&Emo_Ctrl.ImagCurrPi, 0 - Emo_Foc.RotCurr.Imag);
   }
-  else /* (Emo_Status.MotorState == EMO_MOTOR_STATE_RUN) */
+#if (EMO_CFG_IDENT_ENABLED == 1)
+  else if (Emo_Status.MotorState == EMO_MOTOR_STATE_IDENT)
+  {
+    /* Standstill identification of phase resistance and inductance */
+    Emo_lExeIdent();
+  }
+#endif
+#if (EMO_CFG_IPD_ENABLED == 1)
+  else if (Emo_Status.MotorState == EMO_MOTOR_STATE_IPD)
+  {
+    /* Initial rotor position detection by voltage pulses */
+    Emo_lExeIpd();
+  }
+#endif
+  else /* (Emo_Status.MotorState == EMO_MOTOR_STATE_RUN) or EMO_MOTOR_STATE_CATCH */
   {
-    /* Closed loop: */
+    /* Closed loop, for catch spin with RefCurr = 0: */
     /* Speed calculation */
     Emo_Ctrl.PtrAngle = (Emo_Ctrl.PtrAngle + 1) & 0x1f;
 
@@ -290,16 +420,30 @@ void Emo_HandleFoc(void)
     /* Filter speed */
     Emo_Ctrl.ActSpeed = Mat_ExeLp_without_min_max(&Emo_Ctrl.SpeedLp, Speed);
     Emo_FluxAnglePll();
+#if (EMO_CFG_HANDOVER_ENABLED == 1)
+    Emo_lHandoverBlend();
+    /* PLL output angle plus decaying offset of the handover */
+    Emo_Foc.Angle = Emo_Ctrl.FluxAnglePll + (uint16)Emo_Ctrl.AngleOffset;
+#else
     /* assign PLL output angle to Emo_Foc.Angle */
     Emo_Foc.Angle = Emo_Ctrl.FluxAnglePll;
+#endif
 #if (EMO_DECOUPLING==0)
     /* Current Regulator: Execute PI algorithm for rotating voltage */
     /* id */
+#if (EMO_CFG_FIELD_WEAK_ENABLED == 1)
+    Emo_Foc.RotVolt.Real = Mat_ExePi(&Emo_Ctrl.RealCurrPi, Emo_Ctrl.RefCurrReal - Emo_Foc.RotCurr.Real);
+#else
     Emo_Foc.RotVolt.Real = Mat_ExePi(&Emo_Ctrl.RealCurrPi, 0 - Emo_Foc.RotCurr.Real);
+#endif
     /* iq */
     Emo_Foc.RotVolt.Imag = Mat_ExePi(&Emo_Ctrl.ImagCurrPi, Emo_Ctrl.RefCurr - Emo_Foc.RotCurr.Imag);
+#else
+#if (EMO_CFG_FIELD_WEAK_ENABLED == 1)
+    Emo_Foc.RotVoltCurrentcontrol.Real = Mat_ExePi(&Emo_Ctrl.RealCurrPi, Emo_Ctrl.RefCurrReal - Emo_Foc.RotCurr.Real);
 #else
     Emo_Foc.RotVoltCurrentcontrol.Real = Mat_ExePi(&Emo_Ctrl.RealCurrPi, 0 - Emo_Foc.RotCurr.Real);
+#endif
     Emo_Foc.RotVoltCurrentcontrol.Imag = Mat_ExePi(&Emo_Ctrl.ImagCurrPi, Emo_Ctrl.RefCurr - Emo_Foc.RotCurr.Imag);
     /* Calculate Decoupling */
     Emo_Foc.RotVolt = Emo_CurrentDecoupling();
@@ -307,9 +451,20 @@ void Emo_HandleFoc(void)
   }
 
   /* DC-link voltage correction */
-  Vect1.Real = __SSAT(Mat_FixMulScale(Emo_Foc.RotVolt.Real, Emo_Foc.Dcfactor1, 1), MAT_FIX_SAT);
-  Vect1.Imag = __SSAT(Mat_FixMulScale(Emo_Foc.RotVolt.Imag, Emo_Foc.Dcfactor1, 1), MAT_FIX_SAT);
+  Vect1.Real = Mat_SsatCnt(Mat_FixMulScale(Emo_Foc.RotVolt.Real, Emo_Foc.Dcfactor1, 1), MAT_FIX_SAT, EMO_SAT_DCLINK_VOLT);
+  Vect1.Imag = Mat_SsatCnt(Mat_FixMulScale(Emo_Foc.RotVolt.Imag, Emo_Foc.Dcfactor1, 1), MAT_FIX_SAT, EMO_SAT_DCLINK_VOLT);
   /* Limitation Algorithm */
+#if (EMO_CFG_SVM_OVERMOD == 1)
+  /* no limitation of the vector, overmodulation in Emo_lExeSvm */
+  angle = Mat_CalcAngleAmp(Vect1, &ampl);
+
+  /* limitation of max. amplitude: six-step */
+  if (ampl > Emo_Svm.MaxAmpOvm)
+  {
+    ampl = Emo_Svm.MaxAmpOvm;
+  }
+
+#else
   Vect2 = Limitsvektor(&Vect1, &Emo_Svm);
   /* Cartesian to Polar Transformation **
   ** outputs; angle, ampl              */
@@ -321,6 +476,8 @@ void Emo_HandleFoc(void)
     ampl = Emo_Svm.MaxAmp;
   }
 
+#endif
+
   if (Emo_Svm.CounterOffsetAdw > 127)
   {
     Emo_Svm.Amp = ampl;
@@ -355,12 +512,25 @@ void Emo_HandleFoc(void)
   Emo_Svm.Angle = angle + Emo_Foc.Angle;
   /* Perform Polar-2-Cartesian transformation      **
   ** preparation of input values for FluxEstimator */
-  Emo_Foc.StatVoltAmpM = __SSAT(Mat_FixMulScale(Emo_Svm.Amp, Emo_Foc.Dcfactor2, 3), MAT_FIX_SAT);
+  Emo_Foc.StatVoltAmpM = Mat_SsatCnt(Mat_FixMulScale(Emo_Svm.Amp, Emo_Foc.Dcfactor2, 3), MAT_FIX_SAT, EMO_SAT_STAT_VOLT);
   Emo_Foc.StatVolt = Mat_PolarKartesisch(Emo_Foc.StatVoltAmpM, Emo_Svm.Angle);
   /* Perform space vector modulation */
   Emo_lExeSvm(&Emo_Svm);
   /* Filter for Iq  */
   Emo_Ctrl.RotCurrImagdisplay = Mat_ExeLp_without_min_max(&Emo_Ctrl.RotCurrImagLpdisplay, Emo_Foc.RotCurr.Imag);
+#if (EMO_CFG_REC_ENABLED == 1)
+  /* Flight recorder */
+#if (EMO_CFG_RUNTIME_MEAS_ENABLED == 1)
+  RtRecStart = Emo_RtStart();
+  Emo_RecCapture();
+  Emo_RtStop(EMO_RT_REC, RtRecStart);
+#else
+  Emo_RecCapture();
+#endif
+#endif
+#if (EMO_CFG_RUNTIME_MEAS_ENABLED == 1)
+  Emo_RtStop(EMO_RT_FOC, RtStart);
+#endif
 } /* End of Emo_HandleFoc */
 
 
@@ -393,17 +563,26 @@ __STATIC_INLINE void Emo_lExeSvm(TEmo_Svm *pSvm)
   uint16 i;
   uint16 per;
   sint32 ci;
+  uint32 Amp;
   /* Calculate sector number 0..5 and table index 0..255 */
   Angle = ((uint32)pSvm->Angle) * 6u;
   Sector = (Angle >> 16u) & 7;
   pSvm->Sector = (uint16)Sector;
   Index = (Angle >> 8u) & 0xFFu;
+#if (EMO_CFG_SVM_OVERMOD == 1)
+  Amp = Emo_lOvmPrepare(pSvm, &Index);
+#else
+  Amp = pSvm->Amp;
+#endif
   /* Calculate and limit times */
-  T1 = (((uint32)pSvm->Amp) * Table_Sin60[255u - Index]) >> (MAT_FIX_SHIFT + 1);
+  T1 = (Amp * Table_Sin60[255u - Index]) >> (MAT_FIX_SHIFT + 1);
   pSvm->T1 = (sint16)T1;
   /* RandVector1 = Amp * sin(gamma) */
-  T2 = (((uint32)pSvm->Amp) * Table_Sin60[Index]) >> (MAT_FIX_SHIFT + 1);
+  T2 = (Amp * Table_Sin60[Index]) >> (MAT_FIX_SHIFT + 1);
   pSvm->T2 = (sint16)T2;
+#if (EMO_CFG_SVM_OVERMOD == 1)
+  Emo_lOvmProject(pSvm, &T1, &T2);
+#endif
   /* in case of sector borders this defines the min. Null Vector duration **
   ** 10 ticks => 250ns@40MHz                                              **/
   per = CCU6_T12PR;
@@ -995,26 +1174,411 @@ __STATIC_INLINE void Emo_lExeSvm(TEmo_Svm *pSvm)
   pSvm->comp61down = Compare1down;
   pSvm->comp62down = Compare2down;
 
+#if (EMO_CFG_DT_COMP_ENABLED == 1)
+  Emo_lDtComp(pSvm);
+#endif
+#if (EMO_CFG_JITTER_MON_ENABLED == 1)
+  Emo_lJitUpdate();
+#endif
+
   /*ensure loading of shadow registers only during T12 down_counting part*/
   if (CCU6->TCTR0.bit.CDIR == 0)
   {
     /* T12 still in up-counting part, enable T12 Period Match Interrupt **
     ** to load the shadow register inside extra ISR                    */
+#if (EMO_CFG_JITTER_MON_ENABLED == 1)
+    Emo_JitMon.Pending = 1u;
+#endif
     CCU6->IEN.bit.ENT12PM = 1;
   }
   else
   {
     /* T12 in down-counting part, load shadow register */
-    CCU6_LoadShadowRegister_CC60(Emo_Svm.comp60up);
-    CCU6_LoadShadowRegister_CC61(Emo_Svm.comp61up);
-    CCU6_LoadShadowRegister_CC62(Emo_Svm.comp62up);
-    CCU6_EnableST_T12();
-    /* Set Timer13 Trigger calculated previous period zero-match*/
-    CCU6_SetT13Trigger(0x7a);
-    /* Set T13 Compare Value */
-    CCU6_SetT13Compare(Emo_Svm.CompT13ValueUp);
+    Emo_PwmLoadUp();
   }
 } /* End of Emo_lExeSvm */
+
+#if (EMO_CFG_SVM_OVERMOD == 1)
+/** \brief Prepares amplitude and table index for overmodulation.
+ *
+ * The amplitude is the demanded fundamental. Up to MaxAmp the modulation is
+ * linear. In region I (up to OvmAmp2) the circle is stretched up to the
+ * vertex radius and cut by the hexagon in Emo_lOvmProject. In region II the
+ * vector is held at the vertices for an index range growing up to 128,
+ * which is six-step at MaxAmpOvm, the remaining index range runs along the
+ * hexagon edge. Stretch and hold index are taken from tables, so that the
+ * fundamental follows the demanded amplitude.
+ *
+ * \param[inout] pSvm Pointer to SVM status
+ * \param[inout] pIndex Table index inside the sector 0..255
+ *
+ * \return Amplitude for the times T1 and T2
+ * \ingroup emo_api
+ */
+__STATIC_INLINE uint32 Emo_lOvmPrepare(TEmo_Svm *pSvm, uint32 *pIndex)
+{
+  uint32 Amp;
+  uint32 Hold;
+  uint32 Index;
+  Amp = pSvm->Amp;
+
+  if (Amp <= pSvm->MaxAmp)
+  {
+    /* linear region */
+    return Amp;
+  }
+
+  if (Amp <= pSvm->OvmAmp2)
+  {
+    /* region I */
+    return pSvm->MaxAmp + ((pSvm->MaxAmp * Emo_lOvmTable(Table_OvmStretch, Amp, pSvm->MaxAmp, pSvm->OvmGain1)) >> 15);
+  }
+
+  /* region II */
+  Hold = Emo_lOvmTable(Table_OvmHold, Amp, pSvm->OvmAmp2, pSvm->OvmGain2);
+  Index = *pIndex;
+
+  if (Index < Hold)
+  {
+    Index = 0u;
+  }
+  else if (Index > (255u - Hold))
+  {
+    Index = 255u;
+  }
+  else
+  {
+    /* (Index - Hold) * 256 / (256 - 2 * Hold) */
+    Index = Mat_DivRecip((Index - Hold) << 8, (uint16)(256u - (Hold << 1)));
+
+    if (Index > 255u)
+    {
+      Index = 255u;
+    }
+  }
+
+  *pIndex = Index;
+  return pSvm->OvmAmpVertex;
+} /* End of Emo_lOvmPrepare */
+
+/** \brief Interpolates an overmodulation table.
+ *
+ * \param[in] pTable Table with TABLE_SIZE_OVM entries
+ * \param[in] Amp Demanded amplitude
+ * \param[in] Base Amplitude of the first entry
+ * \param[in] Gain Table steps per amplitude *65536*256
+ *
+ * \return Interpolated table value
+ * \ingroup emo_api
+ */
+__STATIC_INLINE uint32 Emo_lOvmTable(const uint16 *pTable, uint32 Amp, uint32 Base, uint32 Gain)
+{
+  uint32 Pos;
+  uint32 i;
+  Pos = ((Amp - Base) * Gain) >> 16;
+
+  if (Pos > (((TABLE_SIZE_OVM - 1u) << 8) - 1u))
+  {
+    Pos = ((TABLE_SIZE_OVM - 1u) << 8) - 1u;
+  }
+
+  i = Pos >> 8;
+  return pTable[i] + ((((sint32)pTable[i + 1u] - (sint32)pTable[i]) * (sint32)(Pos & 0xFFu)) >> 8);
+} /* End of Emo_lOvmTable */
+
+/** \brief Limits the active vector times to the hexagon.
+ *
+ * Outside the hexagon the nearest point on the edge is taken, this keeps
+ * T1 - T2 and needs no division. In overmodulation the zero vectors are
+ * too short to shift the pattern for the single shunt measurement, so the
+ * skip is decided from the shorter active vector of the final pattern
+ * (after Emo_lOvmPrepare and the projection), also inside the hexagon
+ * and for the vertex hold with T2 = 0: if it is shorter than half the
+ * measurement window EMO_SVM_MINTIME, the current sample is skipped. In
+ * the linear region the asymmetric shift opens the window, no skip.
+ *
+ * \param[inout] pSvm Pointer to SVM status
+ * \param[inout] pT1 Time of the first active vector
+ * \param[inout] pT2 Time of the second active vector
+ *
+ * \return None
+ * \ingroup emo_api
+ */
+__STATIC_INLINE void Emo_lOvmProject(TEmo_Svm *pSvm, sint32 *pT1, sint32 *pT2)
+{
+  sint32 Diff;
+  sint32 Short;
+  pSvm->MeasSkip = 0u;
+
+  if ((*pT1 + *pT2) > EMO_SVM_TMAX)
+  {
+    Diff = *pT1 - *pT2;
+
+    if (Diff > EMO_SVM_TMAX)
+    {
+      Diff = EMO_SVM_TMAX;
+    }
+    else if (Diff < -EMO_SVM_TMAX)
+    {
+      Diff = -EMO_SVM_TMAX;
+    }
+    else
+    {
+      /* on the edge */
+    }
+
+    *pT1 = (EMO_SVM_TMAX + Diff) >> 1;
+    *pT2 = (EMO_SVM_TMAX - Diff) >> 1;
+    pSvm->T1 = (sint16)*pT1;
+    pSvm->T2 = (sint16)*pT2;
+  }
+
+  if (pSvm->Amp > pSvm->MaxAmp)
+  {
+    Short = *pT1;
+
+    if (*pT2 < Short)
+    {
+      Short = *pT2;
+    }
+
+    if (Short < (EMO_SVM_MINTIME / 2))
+    {
+      pSvm->MeasSkip = 1u;
+    }
+  }
+} /* End of Emo_lOvmProject */
+#endif
+
+#if (EMO_CFG_DT_COMP_ENABLED == 1)
+/** \brief Compensates the deadtime and switching delay of the bridge.
+ *
+ * The phase reference currents follow from the rotating reference current
+ * at the rotor angle. The measurement window of the ADC is left at the
+ * uncorrected compares, the corrected edges are delayed by the deadtime in
+ * the bridge to this position again.
+ * The voltage error of the inverter is modeled from the measured phase
+ * currents, the difference to the applied correction is added to the
+ * stator voltage of the flux estimator.
+ *
+ * \param[inout] pSvm Pointer to SVM status
+ *
+ * \return None
+ * \ingroup emo_api
+ */
+__STATIC_INLINE void Emo_lDtComp(TEmo_Svm *pSvm)
+{
+  TComplex RotRef;
+  TComplex StatRef;
+  sint32 RefB;
+  sint32 DevA;
+  sint32 DevB;
+  sint32 DevC;
+  sint32 Temp;
+
+  if (((Emo_Status.MotorState == EMO_MOTOR_STATE_RUN) || (Emo_Status.MotorState == EMO_MOTOR_STATE_START)) && (pSvm->CounterOffsetAdw > 127))
+  {
+#if (EMO_CFG_FIELD_WEAK_ENABLED == 1)
+    RotRef.Real = Emo_Ctrl.RefCurrReal;
+#else
+    RotRef.Real = 0;
+#endif
+    RotRef.Imag = Emo_Ctrl.RefCurr;
+    /* stationary reference in phase current units */
+    StatRef = Mat_InvPark(RotRef, Emo_Foc.Angle);
+    /* Ib = -Ialpha / 2 + sqrt(3) / 2 * Ibeta */
+    RefB = ((sint32)StatRef.Imag * 28378 - (sint32)StatRef.Real * 16384) >> MAT_FIX_SHIFT;
+    DevA = Emo_lDtCompPhase(pSvm, &pSvm->comp60up, &pSvm->comp60down, StatRef.Real, pSvm->PhaseCurr.A);
+    DevB = Emo_lDtCompPhase(pSvm, &pSvm->comp61up, &pSvm->comp61down, RefB, pSvm->PhaseCurr.B);
+    DevC = Emo_lDtCompPhase(pSvm, &pSvm->comp62up, &pSvm->comp62down, -StatRef.Real - RefB,
+                            -(sint32)pSvm->PhaseCurr.A - pSvm->PhaseCurr.B);
+    /* Clarke of the remaining deviation, amplitude to voltage as StatVoltAmpM */
+    Temp = (((DevA + DevA - DevB - DevC) * (sint32)pSvm->DtcKa) >> 16) * Emo_Foc.Dcfactor2;
+    Emo_Foc.StatVolt.Real = (sint16)Mat_SsatCnt(Emo_Foc.StatVolt.Real + (Temp >> 12), MAT_FIX_SAT, EMO_SAT_DT_COMP);
+    Temp = (((DevB - DevC) * (sint32)pSvm->DtcKb) >> 16) * Emo_Foc.Dcfactor2;
+    Emo_Foc.StatVolt.Imag = (sint16)Mat_SsatCnt(Emo_Foc.StatVolt.Imag + (Temp >> 12), MAT_FIX_SAT, EMO_SAT_DT_COMP);
+  }
+  else
+  {
+    /* no compensation */
+  }
+} /* End of Emo_lDtComp */
+
+
+/** \brief Corrects the compares of one phase by the deadtime.
+ *
+ * Compares at 0 or above the period have no switching edge and are left.
+ *
+ * \param[in] pSvm Pointer to SVM status
+ * \param[inout] pUp Compare of the up-counting part
+ * \param[inout] pDown Compare of the down-counting part
+ * \param[in] Ref Phase reference current
+ * \param[in] Act Measured phase current
+ *
+ * \return Deviation of the phase voltage from the demanded in ticks *16
+ * \ingroup emo_api
+ */
+__STATIC_INLINE sint32 Emo_lDtCompPhase(TEmo_Svm *pSvm, uint16 *pUp, uint16 *pDown, sint32 Ref, sint32 Act)
+{
+  sint32 Corr;
+  sint32 Loss;
+  sint32 Dev;
+  sint32 ci;
+  /* correction and inverter error per compare in ticks *16 */
+  if (Ref > pSvm->DtcBand)
+  {
+    Ref = pSvm->DtcBand;
+  }
+  else if (Ref < -pSvm->DtcBand)
+  {
+    Ref = -pSvm->DtcBand;
+  }
+  else
+  {
+    /* linear transition */
+  }
+
+  if (Act > pSvm->DtcBand)
+  {
+    Act = pSvm->DtcBand;
+  }
+  else if (Act < -pSvm->DtcBand)
+  {
+    Act = -pSvm->DtcBand;
+  }
+  else
+  {
+    /* linear transition */
+  }
+
+  Corr = (((Ref * pSvm->DtcGain) >> MAT_FIX_SHIFT) + 8) >> 4;
+  Loss = (Act * pSvm->DtcGain) >> MAT_FIX_SHIFT;
+  Dev = 0;
+
+  if ((*pUp != 0u) && (*pUp <= CCU6_T12PR))
+  {
+    ci = (sint32)*pUp - Corr;
+
+    if (ci < 1)
+    {
+      ci = 1;
+    }
+    else if (ci > CCU6_T12PR)
+    {
+      ci = CCU6_T12PR;
+    }
+    else
+    {
+      /* inside the period */
+    }
+
+    Dev += (((sint32)*pUp - ci) << 4) - Loss;
+    *pUp = (uint16)ci;
+  }
+
+  if ((*pDown != 0u) && (*pDown <= CCU6_T12PR))
+  {
+    ci = (sint32)*pDown - Corr;
+
+    if (ci < 1)
+    {
+      ci = 1;
+    }
+    else if (ci > CCU6_T12PR)
+    {
+      ci = CCU6_T12PR;
+    }
+    else
+    {
+      /* inside the period */
+    }
+
+    Dev += (((sint32)*pDown - ci) << 4) - Loss;
+    *pDown = (uint16)ci;
+  }
+
+  /* one tick of both compares is one tick of the phase voltage */
+  return Dev / 2;
+} /* End of Emo_lDtCompPhase */
+#endif
+
+#if (EMO_CFG_JITTER_MON_ENABLED == 1)
+/** \brief Returns the position of T12 in the PWM period.
+ *
+ * \return T12 ticks since zero match, 0..EMO_JIT_PERIOD-1
+ */
+__STATIC_INLINE uint16 Emo_lJitPos(void)
+{
+  uint16 Cnt;
+  uint16 Pos;
+  Cnt = (uint16)CCU6->T12.reg;
+
+  if (CCU6->TCTR0.bit.CDIR == 0)
+  {
+    Pos = Cnt;
+  }
+  else
+  {
+    Pos = (uint16)(EMO_JIT_PERIOD - 1u - Cnt);
+  }
+
+  return Pos;
+} /* End of Emo_lJitPos */
+
+
+/** \brief Evaluates the timing of the PWM update, called right before the
+ *  up-counting compare values are loaded.
+ *
+ * Up-counting values are loaded directly in the down-counting part and
+ * transferred at the one match, otherwise by the period match interrupt.
+ * The closer the update is to one of these events, the more likely an
+ * interrupt entry delay or preemption shifts it into the wrong period.
+ *
+ * \return None
+ */
+__STATIC_INLINE void Emo_lJitUpdate(void)
+{
+  uint16 Cnt;
+  uint16 Margin;
+  uint16 Elapsed;
+  Cnt = (uint16)CCU6->T12.reg;
+  Elapsed = (uint16)((Emo_lJitPos() + EMO_JIT_PERIOD - Emo_JitMon.StartPos) % EMO_JIT_PERIOD);
+  Emo_JitMon.Periods++;
+  Emo_JitMon.EndLast = Elapsed;
+
+  if (Elapsed > Emo_JitMon.EndMax)
+  {
+    Emo_JitMon.EndMax = Elapsed;
+  }
+
+  if (CCU6->IS.bit.T12OM == 1u)
+  {
+    /* one match of the next period passed already */
+    Emo_JitMon.Overrun++;
+  }
+
+  if (CCU6->TCTR0.bit.CDIR == 0)
+  {
+    Emo_JitMon.Deferred++;
+    Margin = (uint16)(CCU6_T12PR - Cnt);
+  }
+  else
+  {
+    Emo_JitMon.Direct++;
+    Margin = Cnt;
+  }
+
+  if (Margin < Emo_JitMon.MarginMin)
+  {
+    Emo_JitMon.MarginMin = Margin;
+  }
+
+  if (Margin < EMO_JIT_MARGIN)
+  {
+    Emo_JitMon.Critical++;
+  }
+} /* End of Emo_lJitUpdate */
+#endif
 __STATIC_INLINE void Emo_lEstFlux(void)
 {
   sint16 Temp;
@@ -1024,18 +1588,18 @@ __STATIC_INLINE void Emo_lEstFlux(void)
   static TComplex Fluxrf;
   static TComplex Flux;
   /* Get stator flux in real axis */
-  Temp = __SSAT(Fluxrf.Real + Emo_Foc.StatVolt.Real - Mat_FixMul(Emo_Foc.StatCurr.Real, Emo_Foc.PhaseRes), MAT_FIX_SAT);
+  Temp = Mat_SsatCnt(Fluxrf.Real + Emo_Foc.StatVolt.Real - Mat_FixMul(Emo_Foc.StatCurr.Real, Emo_Foc.PhaseRes), MAT_FIX_SAT, EMO_SAT_FLUX_VOLT);
   fluxh.Real = Mat_ExeLp_without_min_max(&Emo_Foc.RealFluxLp, Temp);
-  Flux.Real = __SSAT(fluxh.Real - Mat_FixMulScale(Emo_Foc.StatCurr.Real, Emo_Foc.PhaseInd, 0), MAT_FIX_SAT);
+  Flux.Real = Mat_SsatCnt(fluxh.Real - Mat_FixMulScale(Emo_Foc.StatCurr.Real, Emo_Foc.PhaseInd, 0), MAT_FIX_SAT, EMO_SAT_FLUX);
   /* Get stator flux in imaginary axis */
-  Temp = __SSAT(Fluxrf.Imag + Emo_Foc.StatVolt.Imag - Mat_FixMul(Emo_Foc.StatCurr.Imag, Emo_Foc.PhaseRes), MAT_FIX_SAT);
+  Temp = Mat_SsatCnt(Fluxrf.Imag + Emo_Foc.StatVolt.Imag - Mat_FixMul(Emo_Foc.StatCurr.Imag, Emo_Foc.PhaseRes), MAT_FIX_SAT, EMO_SAT_FLUX_VOLT);
   fluxh.Imag = Mat_ExeLp_without_min_max(&Emo_Foc.ImagFluxLp, Temp);
-  Flux.Imag = __SSAT(fluxh.Imag - Mat_FixMulScale(Emo_Foc.StatCurr.Imag, Emo_Foc.PhaseInd, 0), MAT_FIX_SAT);
+  Flux.Imag = Mat_SsatCnt(fluxh.Imag - Mat_FixMulScale(Emo_Foc.StatCurr.Imag, Emo_Foc.PhaseInd, 0), MAT_FIX_SAT, EMO_SAT_FLUX);
   /* Calculate flux angle */
   /* Tempu => FluxAmplitude */
   Emo_Foc.FluxAngle =  Mat_CalcAngleAmp(Flux, &Tempu);
   /*Tempu = (Tempu * 32000) / 32768 => ensure that FluxAmplitude will not clamp*/
-  FluxAbsValue = __SSAT(Mat_FixMul(Tempu, 32000), MAT_FIX_SAT + 1);
+  FluxAbsValue = Mat_SsatCnt(Mat_FixMul(Tempu, 32000), MAT_FIX_SAT + 1, EMO_SAT_FLUX_ABS);
   /*filtered FluxBetrag as reference for checkings below*/
   Temp = Mat_ExeLp_without_min_max(&Emo_Ctrl.FluxbtrLp, FluxAbsValue);
 
@@ -1072,12 +1636,97 @@ __STATIC_INLINE void Emo_lEstFlux(void)
   }
 } /* End of Emo_lEstFlux */
 
+#if (EMO_CFG_HANDOVER_ENABLED == 1)
+/** \brief Counts the start periods in which the flux estimator is locked.
+ *
+ * Locked: flux amplitude high enough, PLL follows the estimated angle
+ * and the open loop current angle is ahead of the estimated flux in the
+ * direction of rotation, so the current produces torque in this
+ * direction. In negative rotation the lead is a negative angle, it is
+ * negated to use the same window.
+ */
+__STATIC_INLINE void Emo_lHandoverConf(void)
+{
+  sint16 PllErr;
+  sint16 Lead;
+  PllErr = (sint16)(Emo_Foc.FluxAngle - Emo_Ctrl.FluxAnglePll);
+  Lead = (sint16)(Emo_Foc.StartAngle - Emo_Ctrl.FluxAnglePll);
+
+  if (Emo_Ctrl.RefSpeed < 0)
+  {
+    Lead = -Lead;
+  }
+
+  if (((Emo_Ctrl.FluxbtrLp.Out >> 15) > EMO_HANDOVER_MIN_FLUX) &&
+      (PllErr < EMO_HANDOVER_MAX_PLL_ERR) && (PllErr > -EMO_HANDOVER_MAX_PLL_ERR) &&
+      (Lead > EMO_HANDOVER_MIN_LEAD) && (Lead < EMO_HANDOVER_MAX_LEAD))
+  {
+    if (Emo_Ctrl.HandoverConf < 0xFFFFu)
+    {
+      Emo_Ctrl.HandoverConf++;
+    }
+  }
+  else
+  {
+    Emo_Ctrl.HandoverConf = 0u;
+  }
+} /* End of Emo_lHandoverConf */
+
+
+/** \brief Bumpless transition from open loop to closed loop.
+ *
+ * In start the current is regulated in the real axis of the open loop
+ * angle, in closed loop in the imaginary axis of the PLL angle. In the
+ * first closed loop period the angle offset is set so that the current
+ * vector stays where it is, the frame turns by -90deg, so the PI
+ * integrators are swapped accordingly. The offset then decays to 0.
+ */
+__STATIC_INLINE void Emo_lHandoverBlend(void)
+{
+  sint32 Temp;
+  sint16 Step;
+
+  if (Emo_Ctrl.HandoverStart == 1u)
+  {
+    Emo_Ctrl.HandoverStart = 0u;
+    /* PLL angle + offset + 90deg = open loop angle */
+    Emo_Ctrl.AngleOffset = (sint16)(uint16)(Emo_Foc.StartAngle - Emo_Ctrl.FluxAnglePll - 16384u);
+    /* new imaginary = old real, new real = -old imaginary */
+    Temp = Emo_Ctrl.ImagCurrPi.IOut;
+    Emo_Ctrl.ImagCurrPi.IOut = Emo_Ctrl.RealCurrPi.IOut;
+    Emo_Ctrl.RealCurrPi.IOut = -Temp;
+  }
+  else
+  {
+    Step = Emo_Ctrl.AngleOffset >> EMO_HANDOVER_DECAY_SHIFT;
+
+    if (Step == 0)
+    {
+      if (Emo_Ctrl.AngleOffset > 0)
+      {
+        Step = 1;
+      }
+      else if (Emo_Ctrl.AngleOffset < 0)
+      {
+        Step = -1;
+      }
+      else
+      {
+        /* offset decayed */
+      }
+    }
+
+    Emo_Ctrl.AngleOffset -= Step;
+  }
+} /* End of Emo_lHandoverBlend */
+#endif
+
 __STATIC_INLINE void Emo_FluxAnglePll(void)
 {
   sint16 deltaphi;
   sint16 domega;
   deltaphi = Emo_Foc.FluxAngle - Emo_Ctrl.FluxAnglePll;
-  domega = __SSAT(Mat_FixMulScale(deltaphi, Emo_Ctrl.Pllkp, 0) + Emo_Ctrl.Speedpll, MAT_FIX_SAT);
+  domega = Mat_SsatCnt(Mat_FixMulScale(deltaphi, Emo_Ctrl.Pllkp, 0) + Emo_Ctrl.Speedpll, MAT_FIX_SAT, EMO_SAT_PLL);
   Emo_Ctrl.FluxAnglePll = Emo_Ctrl.FluxAnglePll + domega;
 }
 
@@ -1088,11 +1737,195 @@ __STATIC_INLINE TComplex Emo_CurrentDecoupling(void)
   sint16 Kentk = 10547;
   sint16 Oml;
   Oml = Mat_FixMulScale(Kentk, Emo_Ctrl.SpeedLpdisplay.Out, 1);
-  StatOut.Real = __SSAT(Emo_Foc.RotVoltCurrentcontrol.Real - Mat_FixMulScale(Emo_Foc.RotCurr.Imag, Oml, 1), MAT_FIX_SAT);
-  StatOut.Imag = __SSAT(Emo_Foc.RotVoltCurrentcontrol.Imag + Mat_FixMulScale(Emo_Foc.RotCurr.Real, Oml, 1), MAT_FIX_SAT);
+  StatOut.Real = Mat_SsatCnt(Emo_Foc.RotVoltCurrentcontrol.Real - Mat_FixMulScale(Emo_Foc.RotCurr.Imag, Oml, 1), MAT_FIX_SAT, EMO_SAT_DECOUPLING);
+  StatOut.Imag = Mat_SsatCnt(Emo_Foc.RotVoltCurrentcontrol.Imag + Mat_FixMulScale(Emo_Foc.RotCurr.Real, Oml, 1), MAT_FIX_SAT, EMO_SAT_DECOUPLING);
   return StatOut;
 }
 #endif
 
+#if (EMO_CFG_IDENT_ENABLED == 1)
+/** \brief Performs the standstill identification of phase resistance and inductance.
+ *
+ * DC1/DC2: current regulation in the real axis at angle 0 with half and full
+ * start current, stationary voltage and current are averaged. The resistance
+ * is taken from the difference of both points, this removes the dead time
+ * voltage error.
+ * DECAY/STEP: the voltage of DC2 is applied open loop after the current has
+ * decayed with zero vectors. The current rise inside the step delivers the
+ * inductance. Evaluation is done in Emo_lEvalIdent out of the T2 interrupt.
+ *
+ * \param none
+ *
+ * \return None
+ * \ingroup emo_api
+ */
+__STATIC_INLINE void Emo_lExeIdent(void)
+{
+  Emo_Foc.Angle = 0u;
+  Emo_Foc.RotVolt.Real = 0;
+  Emo_Foc.RotVolt.Imag = 0;
+
+  /* wait for CSA offset estimation (Amp=0) before applying voltage */
+  if (Emo_Svm.CounterOffsetAdw > 127)
+  {
+    switch (Emo_Ident.Phase)
+    {
+      case EMO_IDENT_PHASE_DC1:
+      case EMO_IDENT_PHASE_DC2:
+      {
+        /* id */
+        Emo_Foc.RotVolt.Real = Mat_ExePi(&Emo_Ctrl.RealCurrPi, Emo_Ident.RefCurr - Emo_Foc.RotCurr.Real);
+        /* iq */
+        Emo_Foc.RotVolt.Imag = Mat_ExePi(&Emo_Ctrl.ImagCurrPi, 0 - Emo_Foc.RotCurr.Imag);
+        Emo_Ident.Count++;
+
+        if (Emo_Ident.Count > EMO_IDENT_SETTLE_TIME)
+        {
+          /* angle is 0 => stationary real axis = rotating real axis */
+          Emo_Ident.VoltSum += Emo_Foc.StatVolt.Real;
+          Emo_Ident.CurrSum += Emo_Foc.RotCurr.Real;
+
+          if (Emo_Ident.Count == (EMO_IDENT_SETTLE_TIME + (1u << EMO_IDENT_AVG_SHIFT)))
+          {
+            if (Emo_Ident.Phase == EMO_IDENT_PHASE_DC1)
+            {
+              Emo_Ident.Volt1 = (sint16)(Emo_Ident.VoltSum >> EMO_IDENT_AVG_SHIFT);
+              Emo_Ident.Curr1 = (sint16)(Emo_Ident.CurrSum >> EMO_IDENT_AVG_SHIFT);
+              Emo_Ident.RefCurr = Emo_Foc.StartCurrent;
+              Emo_Ident.Phase = EMO_IDENT_PHASE_DC2;
+            }
+            else
+            {
+              Emo_Ident.Volt2 = (sint16)(Emo_Ident.VoltSum >> EMO_IDENT_AVG_SHIFT);
+              Emo_Ident.Curr2 = (sint16)(Emo_Ident.CurrSum >> EMO_IDENT_AVG_SHIFT);
+              /* keep regulator output of start current for the voltage steps */
+              Emo_Ident.StepVolt = Emo_Foc.RotVolt.Real;
+              Emo_Ident.Phase = EMO_IDENT_PHASE_DECAY;
+            }
+
+            Emo_Ident.Count = 0;
+            Emo_Ident.VoltSum = 0;
+            Emo_Ident.CurrSum = 0;
+          }
+        }
+      }
+      break;
+
+      case EMO_IDENT_PHASE_DECAY:
+      {
+        /* zero vectors only, current decays with L/R */
+        Emo_Ident.Count++;
+
+        if (Emo_Ident.Count == EMO_IDENT_DECAY_TIME)
+        {
+          Emo_Ident.Count = 0;
+          Emo_Ident.Phase = EMO_IDENT_PHASE_STEP;
+        }
+      }
+      break;
+
+      case EMO_IDENT_PHASE_STEP:
+      {
+        Emo_Foc.RotVolt.Real = Emo_Ident.StepVolt;
+        Emo_Ident.Count++;
+
+        /* current measurement lags the applied voltage, therefore the **
+        ** rise is taken between two samples inside the step           */
+        if (Emo_Ident.Count == EMO_IDENT_STEP_DELAY)
+        {
+          Emo_Ident.StepCurr = Emo_Foc.RotCurr.Real;
+        }
+        else if (Emo_Ident.Count == (EMO_IDENT_STEP_DELAY + EMO_IDENT_STEP_TIME))
+        {
+          Emo_Ident.StepDeltaSum += Emo_Foc.RotCurr.Real - Emo_Ident.StepCurr;
+          Emo_Ident.StepCurrSum += Emo_Foc.RotCurr.Real + Emo_Ident.StepCurr;
+          Emo_Ident.Repeat++;
+          Emo_Ident.Count = 0;
+
+          if (Emo_Ident.Repeat == (1u << EMO_IDENT_STEP_SHIFT))
+          {
+            Emo_Ident.Phase = EMO_IDENT_PHASE_DONE;
+          }
+          else
+          {
+            Emo_Ident.Phase = EMO_IDENT_PHASE_DECAY;
+          }
+        }
+        else
+        {
+          /* do nothing */
+        }
+      }
+      break;
+
+      default:
+      {
+        /* EMO_IDENT_PHASE_DONE: zero vectors until T2 evaluation */
+      }
+      break;
+    }
+  }
+} /* End of Emo_lExeIdent */
+#endif
+
+#if (EMO_CFG_IPD_ENABLED == 1)
+/** \brief Performs the initial rotor position detection.
+ *
+ * A voltage pulse is applied in the real axis at each of the EMO_IPD_PULSES
+ * angles, followed by zero vectors until the current has decayed. The peak
+ * of the real current is stored per pulse: it is highest in the direction
+ * of the lowest inductance, i.e. the d-axis, and a little higher towards
+ * the north pole by saturation. Evaluation is done in Emo_lEvalIpd out of
+ * the T2 interrupt.
+ *
+ * \param none
+ *
+ * \return None
+ * \ingroup emo_api
+ */
+__STATIC_INLINE void Emo_lExeIpd(void)
+{
+  Emo_Foc.RotVolt.Real = 0;
+  Emo_Foc.RotVolt.Imag = 0;
+
+  /* wait for CSA offset estimation (Amp=0) before applying voltage */
+  if ((Emo_Svm.CounterOffsetAdw > 127) && (Emo_Ipd.Done == 0u))
+  {
+    Emo_Foc.Angle = (uint16)(Emo_Ipd.Index * EMO_IPD_STEP);
+    Emo_Ipd.Count++;
+
+    if (Emo_Ipd.Count <= EMO_IPD_PULSE_TIME)
+    {
+      Emo_Foc.RotVolt.Real = Emo_Ipd.Volt;
+    }
+
+    /* current measurement lags the applied voltage, the first period **
+    ** was transformed with the angle of the previous pulse          */
+    if ((Emo_Ipd.Count > 1u) && (Emo_Ipd.Count <= (EMO_IPD_PULSE_TIME + EMO_IPD_MEAS_DELAY)))
+    {
+      if (Emo_Foc.RotCurr.Real > Emo_Ipd.Peak[Emo_Ipd.Index])
+      {
+        Emo_Ipd.Peak[Emo_Ipd.Index] = Emo_Foc.RotCurr.Real;
+      }
+    }
+    else if (Emo_Ipd.Count == (EMO_IPD_PULSE_TIME + EMO_IPD_DECAY_TIME))
+    {
+      Emo_Ipd.Count = 0;
+      Emo_Ipd.Index++;
+
+      if (Emo_Ipd.Index == EMO_IPD_PULSES)
+      {
+        /* zero vectors until T2 evaluation */
+        Emo_Ipd.Done = 1u;
+      }
+    }
+    else
+    {
+      /* do nothing */
+    }
+  }
+} /* End of Emo_lExeIpd */
+#endif
+
 
 
@@ -80,6 +80,9 @@
 #define EMO_MOTOR_STATE_START  (2u)
 #define EMO_MOTOR_STATE_RUN    (3u)
 #define EMO_MOTOR_STATE_FAULT  (4u)
+#define EMO_MOTOR_STATE_IDENT  (5u)
+#define EMO_MOTOR_STATE_CATCH  (6u)
+#define EMO_MOTOR_STATE_IPD    (7u)
 
 #define EMO_ERROR_NONE              (0u)
 #define EMO_ERROR_MOTOR_INIT        (1u)
@@ -100,6 +103,8 @@
 #define EMO_ERROR_MINTIME               (0x0400)
 #define EMO_ERROR_POLPAIR               (0x0800)
 #define EMO_ERROR_CSAOFFSET             (0x1000)
+#define EMO_ERROR_IDENT                 (0x2000)
+#define EMO_ERROR_IPD                   (0x4000)
 
 /* Svm Parameter */
 /* EMO_SVM_MINTIME defines the minimum time slot required to place **
@@ -107,6 +112,17 @@
 ** 80 * CCU6_CLK = 80 * 25ns = 2us                                 */
 #define EMO_SVM_MINTIME           (80)
 #define EMO_SVM_DEADTIME          (30)
+/* Deadtime compensation: switching delay of the bridge in T12 ticks,  **
+** deadtime of the CCU6 (T12DTC.DTM) plus switching delay and phase    **
+** current of the full correction in A (linear below)                  */
+#define EMO_DTC_SW_DELAY          (2.0)
+#define EMO_DTC_TICKS             ((float)(CCU6_T12DTC & 0xFFu) + EMO_DTC_SW_DELAY)
+#define EMO_DTC_CURR_BAND         (0.1)
+/* max. sum of active vector times T1 + T2: hexagon edge */
+#define EMO_SVM_TMAX              (CCU6_T12PR / 2)
+/* field weakening reference with overmodulation, part of MaxAmpOvm **
+** (0.95 => inside region I)                                       */
+#define EMO_SVM_OVM_FW_REF        (0.95)
 #define EMO_DECOUPLING            (0u)
 
 /* FluxEstimator filter time */
@@ -115,6 +131,125 @@
 /*0 = stays in open-loop operation, 1 = switch into closed-loop operation */
 #define EMO_RUN                                   (1)
 
+/* Parameter identification phases */
+#define EMO_IDENT_PHASE_DC1       (0u)
+#define EMO_IDENT_PHASE_DC2       (1u)
+#define EMO_IDENT_PHASE_DECAY     (2u)
+#define EMO_IDENT_PHASE_STEP      (3u)
+#define EMO_IDENT_PHASE_DONE      (4u)
+
+/* Parameter identification timing in PWM periods                  **
+** settle time of current regulator before averaging: 2048 => 102ms **
+** averaging over 2^8 periods, zero vector for current decay 256    **
+** => 12.8ms, current rise evaluated over 8 periods after 2 periods **
+** delay, 2^4 voltage steps                                         */
+#define EMO_IDENT_SETTLE_TIME     (2048u)
+#define EMO_IDENT_AVG_SHIFT       (8u)
+#define EMO_IDENT_DECAY_TIME      (256u)
+#define EMO_IDENT_STEP_DELAY      (2u)
+#define EMO_IDENT_STEP_TIME       (8u)
+#define EMO_IDENT_STEP_SHIFT      (4u)
+
+/* Initial position detection: 12 pulses in 30deg steps (65536/12),      **
+** timing in PWM periods: pulse 4 => 0.2ms, zero vectors for current     **
+** decay 60 => 3ms, peak current taken up to 2 periods after the pulse  **
+** (ADC delay), polarity accepted for a peak difference of max/2^6      */
+#define EMO_IPD_PULSES            (12u)
+#define EMO_IPD_STEP              (5461u)
+#define EMO_IPD_PULSE_TIME        (4u)
+#define EMO_IPD_MEAS_DELAY        (2u)
+#define EMO_IPD_DECAY_TIME        (60u)
+#define EMO_IPD_POL_SHIFT         (6u)
+
+/* Field weakening: PI gains on the voltage amplitude error in SVM units **
+** (MaxAmp = T12PR / table scale), max. d-current as part of             **
+** MaxRefCurrent, to be adapted to the motor                             */
+#define EMO_FW_KP                 (1024)
+#define EMO_FW_KI                 (8192)
+#define EMO_FW_ID_MAX             (0.7)
+
+/* Load observer: start value of the acceleration per q-current in      **
+** speed units/s per A (Kt / J), observer pole 1 - 2^-3 per T2 period   **
+** (about 15ms), internal load current resolution 2^4                  **
+** inertia identification over 2^6 samples with a q-current change of  **
+** at least 200 (Q15) per T2 period, accepted within factor 4           */
+#define EMO_LOBS_ACCEL            (8000.0)
+#define EMO_LOBS_BW_SHIFT         (3u)
+#define EMO_LOBS_SHIFT            (4u)
+#define EMO_LOBS_ID_SHIFT         (6u)
+#define EMO_LOBS_ID_MIN_DI        (200)
+
+/* Speed trajectory: max. acceleration in speed units/s, max. jerk in  **
+** speed units/s^2, speed resolution 2^-12 inside the generator        */
+#define EMO_TRAJ_ACCEL_MAX        (2000.0)
+#define EMO_TRAJ_JERK_MAX         (20000.0)
+#define EMO_TRAJ_SHIFT            (12u)
+
+/* Speed regulator schedule: number of points of Emo_SpeedSched_Cfg,     **
+** back-calculation gain of the saturation to the I output (16384 =>    **
+** half of the saturated part per T2 period), max. change of the       **
+** current limits in A/s                                               */
+#define EMO_SPEED_SCHED_POINTS    (4u)
+#define EMO_SPEED_SCHED_KS        (16384)
+#define EMO_SPEED_SCHED_LIM_SLEW  (20.0)
+
+/* Catch spin: observation time in s with zero current regulation,     **
+** time in s after which a motor without back-EMF is started directly  **
+** and min. estimated flux amplitude for a rotating motor (0.1Vs=32768) */
+#define EMO_CATCH_TIME            (0.2)
+#define EMO_CATCH_DETECT_TIME     (0.05)
+#define EMO_CATCH_MIN_FLUX        (300)
+
+/* Runtime measurement: handler index */
+#define EMO_RT_FOC                (0u)
+#define EMO_RT_ADC1               (1u)
+#define EMO_RT_SHADOW             (2u)
+#define EMO_RT_T2                 (3u)
+#define EMO_RT_REC                (4u)
+#define EMO_RT_NUM                (5u)
+
+/* Timing monitor: T12 ticks per PWM period and min. distance of the **
+** PWM update to the next shadow transfer (40 ticks = 1us)            */
+#define EMO_JIT_PERIOD            (2u * (CCU6_T12PR + 1u))
+#define EMO_JIT_MARGIN            (40u)
+
+/* T13 trigger of the ADC measurement: T13 compare match in up- and **
+** down-counting part of T12 (TCTR2 value)                           */
+#define EMO_T13_TRIG_UP           (0x7Au)
+#define EMO_T13_TRIG_DOWN         (0x76u)
+
+/* DC-link voltage low pass time constant in s, every PWM period */
+#define EMO_DCLINK_LP_TIME        (0.0002)
+
+/* CSA offset tracking: plausible range, low pass shift (time constant **
+** 2^shift samples of 13.1ms) and samples needed for a valid offset,    **
+** the offset measured at initialization counts as the first sample     */
+#define EMO_CSA_OFFS_MIN          (1500u)
+#define EMO_CSA_OFFS_MAX          (1800u)
+#define EMO_CSA_OFFS_SHIFT        (4u)
+#define EMO_CSA_OFFS_VALID        (4u)
+
+/* Handover: min. flux amplitude (0.1Vs=32768), max. PLL error and     **
+** window of the open loop current angle ahead of the estimated flux   **
+** (65536=360deg), periods all conditions must hold, min. start speed  **
+** (StartEndSpeed >> shift) and angle offset decay (2^shift periods)   */
+#define EMO_HANDOVER_MIN_FLUX     (300)
+#define EMO_HANDOVER_MAX_PLL_ERR  (1820)
+#define EMO_HANDOVER_MIN_LEAD     (0)
+#define EMO_HANDOVER_MAX_LEAD     (29127)
+#define EMO_HANDOVER_CONF         (200u)
+#define EMO_HANDOVER_SPEED_SHIFT  (1u)
+#define EMO_HANDOVER_DECAY_SHIFT  (6u)
+
+#if (EMO_CFG_CCU6_FAST_UPDATE == 1)
+/* The direct stores write the complete register, same as the SDK **
+** functions as long as the value fields cover all 16 bits         */
+#if ((CCU6_CC60R_CCV_Msk != 0xFFFFu) || (CCU6_CC61R_CCV_Msk != 0xFFFFu) || \
+     (CCU6_CC62R_CCV_Msk != 0xFFFFu) || (CCU6_CC63R_CCV_Msk != 0xFFFFu))
+#error "EMO_CFG_CCU6_FAST_UPDATE: compare value fields are not 16 bit wide"
+#endif
+#endif
+
 /*******************************************************************************
 **                           Global Type Definitions                          **
 *******************************************************************************/
@@ -175,6 +310,9 @@ typedef struct
   uint32 Kdcdivident1;            /**< \brief Divident for K/Uz 34*/
   uint16 Kdcfactor2;              /**< \brief Factor for K*Uz 34*/
   uint16 Kdcfactoriqc;            /**< \brief Factor for iqcmax=K*Uz  */
+#if (EMO_CFG_DCLINK_FAST == 1)
+  TMat_Lp_Simple DcLinkLp;        /**< \brief Dc Link Voltage low pass */
+#endif
   uint16 StatVoltAmpM;            /**< \brief Amplitude for Stat. Voltage FM 34*/
   uint16 LpCoefb1;                /**< \brief Timeconst for Pt1 Fluxestimator with amp<0.9ampmax   34*/
   uint16 LpCoefb2;                /**< \brief Timeconst for Pt1 Fluxestimator with amp>0.9ampmax 34*/
@@ -209,8 +347,19 @@ typedef struct
   float SpeedLevelSwitchOn;       /**< \brief Speedlevel for switch on */
   float AdjustmCurrentControl;    /**< \brief Adjustment for CurrentControl */
   float MaxSpeed;                 /**< \brief Maximum Speed */
+  uint16 PllKp;                   /**< \brief Proportional gain of flux angle PLL */
 } TEmo_Focpar_Cfg;
 
+/** \brief Speed regulator schedule point */
+typedef struct
+{
+  float Speed;                    /**< \brief Speed (absolute value, ascending) */
+  uint16 SpeedPi_Kp;              /**< \brief Speedcontroller Kp *64 */
+  uint16 SpeedPi_Ki;              /**< \brief Speedcontroller Ki */
+  float MaxRefCurr;               /**< \brief Motoring current limit */
+  float MinRefCurr;               /**< \brief Braking current limit (negative) */
+} TEmo_SpeedSched_Cfg;
+
 
 
 /** \brief Control status */
@@ -221,7 +370,11 @@ typedef struct
   sint16 RefCurr;                 /**< \brief Reference current (imaginary) 2*/
   sint16 ActSpeeddisplay;         /**< \brief Actuel speed display3*/
   uint16 SpeedPiInit;             /**< \brief Initialization value for speed PI 4*/
+#if (EMO_CFG_SPEED_SCHED_ENABLED == 1)
+  TMat_Pi_Windup SpeedPi;         /**< \brief Speed PI control with anti-windup */
+#else
   TMat_Pi SpeedPi;                /**< \brief Speed PI control */
+#endif
   TMat_Pi RealCurrPi;             /**< \brief Real current PI control */
   TMat_Pi ImagCurrPi;             /**< \brief Imaginary current PI control */
   TMat_Lp_Simple SpeedLp;         /**< \brief Speed low pass */
@@ -247,6 +400,38 @@ typedef struct
   uint16 EnableStartVoltage;      /* 99 96*/
   TMat_Lp_Simple RotCurrImagLpdisplay;
   sint16 RotCurrImagdisplay;
+  uint16 CatchTime;               /**< \brief Observation time for catch spin in T2 periods */
+  uint16 CatchCount;              /**< \brief Counter for catch spin */
+  uint16 CatchDetect;             /**< \brief Counter value of the standstill detection */
+  sint16 CatchSpeed;              /**< \brief Speed at half of the observation time */
+  uint16 HandoverCheck;           /**< \brief First closed loop period after the start pending */
+  sint16 HandoverStep;            /**< \brief Step of the q-current reference at the handover */
+#if (EMO_CFG_HANDOVER_ENABLED == 1)
+  uint16 HandoverConf;            /**< \brief Periods with locked estimator in start */
+  uint16 HandoverStart;           /**< \brief Handover to closed loop requested */
+  sint16 AngleOffset;             /**< \brief Angle offset to the PLL angle after handover */
+#endif
+#if (EMO_CFG_FIELD_WEAK_ENABLED == 1)
+  TMat_Pi FwPi;                   /**< \brief Field weakening PI control */
+  sint16 RefCurrReal;             /**< \brief Reference current (real) of field weakening */
+#endif
+#if (EMO_CFG_TRAJ_ENABLED == 1)
+  sint16 CmdSpeed;                /**< \brief Commanded speed, input of the trajectory */
+  uint16 TrajInit;                /**< \brief Trajectory initialized in RUN */
+  sint32 TrajSpeed;               /**< \brief Trajectory speed *2^EMO_TRAJ_SHIFT */
+  sint32 TrajAccel;               /**< \brief Trajectory acceleration per T2 period *2^EMO_TRAJ_SHIFT */
+  sint32 TrajAccelMax;            /**< \brief Max. acceleration per T2 period *2^EMO_TRAJ_SHIFT */
+  sint32 TrajJerk;                /**< \brief Max. acceleration change per T2 period *2^EMO_TRAJ_SHIFT */
+#endif
+#if (EMO_CFG_SPEED_SCHED_ENABLED == 1)
+  sint16 SchedSpeed[EMO_SPEED_SCHED_POINTS];   /**< \brief Speed of the schedule points */
+  sint16 SchedKp[EMO_SPEED_SCHED_POINTS];      /**< \brief Kp of the schedule points */
+  sint16 SchedKi[EMO_SPEED_SCHED_POINTS];      /**< \brief Ki of the schedule points */
+  sint16 SchedMax[EMO_SPEED_SCHED_POINTS];     /**< \brief Motoring current limit of the schedule points */
+  sint16 SchedMin[EMO_SPEED_SCHED_POINTS];     /**< \brief Braking current limit of the schedule points */
+  uint32 SchedGain[EMO_SPEED_SCHED_POINTS - 1u]; /**< \brief 2^24 / speed interval */
+  sint16 SchedLimSlew;            /**< \brief Max. change of the current limits per T2 period */
+#endif
 } TEmo_Ctrl;
 
 
@@ -278,8 +463,110 @@ typedef struct
   uint16 CounterOffsetAdw;         /**< \brief Counter for Adw Offsetestimation*/
   uint32 CsaOffsetAdwSumme;        /**< \brief OffsetValue Adw*/
   uint16 CsaOffsetAdw;             /**< \brief OffsetValue Adw*/
+#if (EMO_CFG_CSA_OFFS_BACKGROUND == 1)
+  uint32 CsaOffsetFilt;            /**< \brief Tracked offset *256 */
+  uint16 CsaOffsetCount;           /**< \brief Samples of the tracked offset */
+#endif
+#if (EMO_CFG_SVM_OVERMOD == 1)
+  uint16 MaxAmpOvm;                /**< \brief Maximum amplitude, six-step fundamental */
+  uint16 OvmAmp2;                  /**< \brief Begin of overmodulation region II */
+  uint16 OvmAmpVertex;             /**< \brief Amplitude of the hexagon vertices */
+  uint32 OvmGain1;                 /**< \brief Region I table steps per amplitude *65536*256 */
+  uint32 OvmGain2;                 /**< \brief Region II table steps per amplitude *65536*256 */
+  uint16 MaxAmpFw;                 /**< \brief Amplitude reference of field weakening */
+  uint16 MeasSkip;                 /**< \brief Pattern without current measurement window */
+  uint16 StoredMeasSkip1;          /**< \brief Stored MeasSkip */
+#endif
+#if (EMO_CFG_DT_COMP_ENABLED == 1)
+  sint16 DtcBand;                  /**< \brief Phase current of the full correction */
+  sint32 DtcGain;                  /**< \brief Correction *16 per phase current *32768 */
+  uint16 DtcKa;                    /**< \brief Alpha: amplitude per tick *4096 */
+  uint16 DtcKb;                    /**< \brief Beta: amplitude per tick *4096 */
+#endif
 } TEmo_Svm;
 
+/** \brief Parameter identification status */
+typedef struct
+{
+  uint16 Phase;                   /**< \brief Identification phase */
+  uint16 Count;                   /**< \brief Period counter inside phase */
+  uint16 Repeat;                  /**< \brief Counter for voltage steps */
+  uint16 Done;                    /**< \brief Identification executed since power-up */
+  sint16 RefCurr;                 /**< \brief Reference current (real) for DC phases */
+  sint16 StepVolt;                /**< \brief Rotating voltage (real) applied during steps */
+  sint16 StepCurr;                /**< \brief Current at begin of evaluated step interval */
+  sint16 Volt1;                   /**< \brief Mean voltage at half start current */
+  sint16 Curr1;                   /**< \brief Mean current at half start current */
+  sint16 Volt2;                   /**< \brief Mean voltage at start current */
+  sint16 Curr2;                   /**< \brief Mean current at start current */
+  sint32 VoltSum;                 /**< \brief Sum for voltage averaging */
+  sint32 CurrSum;                 /**< \brief Sum for current averaging */
+  sint32 StepDeltaSum;            /**< \brief Sum of current rise over all steps */
+  sint32 StepCurrSum;             /**< \brief Sum of current at begin and end of all steps */
+  uint32 PhaseResNom;             /**< \brief Phase resistance of configuration, not saturated */
+  uint32 PhaseIndNom;             /**< \brief Phase inductance of configuration, not saturated */
+  uint32 PhaseResAct;             /**< \brief Phase resistance in use, not saturated */
+  uint32 PhaseIndAct;             /**< \brief Phase inductance in use, not saturated */
+  uint16 KpFactor;                /**< \brief Current PI Kp per PhaseInd *4096 */
+  uint16 KiFactor;                /**< \brief Current PI Ki per PhaseRes *4096 */
+} TEmo_Ident;
+
+/** \brief Initial position detection status */
+typedef struct
+{
+  uint16 Index;                   /**< \brief Pulse number, pulse angle Index * EMO_IPD_STEP */
+  uint16 Count;                   /**< \brief Period counter inside pulse and decay */
+  uint16 Done;                    /**< \brief All pulses applied */
+  sint16 Volt;                    /**< \brief Rotating voltage (real) of the pulses */
+  sint16 Peak[EMO_IPD_PULSES];    /**< \brief Peak current (real) per pulse */
+  uint16 Angle;                   /**< \brief Detected rotor angle */
+} TEmo_Ipd;
+
+/** \brief Load observer status, load current in q-current units *2^EMO_LOBS_SHIFT */
+typedef struct
+{
+  uint16 Init;                    /**< \brief Observer initialized in RUN */
+  sint32 Z;                       /**< \brief Observer state, LoadCurr + LoadGain * ActSpeed */
+  sint32 LoadCurr;                /**< \brief Estimated load current */
+  uint32 LoadGain;                /**< \brief Observer gain per speed, 2^-BW_SHIFT / Inertia */
+  uint32 Inertia;                 /**< \brief Acceleration per T2 period and q-current *2^20 */
+  uint32 InertiaNom;              /**< \brief Inertia of configuration */
+  sint16 LastSpeed;               /**< \brief Speed of last period */
+  sint16 LastAccel;               /**< \brief Acceleration of last period */
+  sint16 LastIq;                  /**< \brief q-current of last period */
+  sint16 LastIq2;                 /**< \brief q-current of second last period */
+  sint64 IdSxy;                   /**< \brief Identification: sum of dAccel * dIq */
+  sint64 IdSxx;                   /**< \brief Identification: sum of dIq^2 */
+  uint16 IdCount;                 /**< \brief Identification: number of samples */
+  uint16 IdUpdates;               /**< \brief Identification: accepted updates */
+} TEmo_LoadObs;
+
+/** \brief Runtime measurement of one handler in CPU cycles, time spent in
+ *  preempting interrupts is included */
+typedef struct
+{
+  uint32 Calls;                   /**< \brief Number of calls */
+  uint32 CyclesLast;              /**< \brief Cycles of the last call */
+  uint32 CyclesMax;               /**< \brief Max. cycles since reset */
+  uint64 CyclesSum;               /**< \brief Accumulated cycles since reset */
+} TEmo_RtMeas;
+
+/** \brief Timing monitor of the PWM update, times in T12 ticks (25ns) */
+typedef struct
+{
+  uint32 Periods;                 /**< \brief Number of PWM updates */
+  uint32 Deferred;                /**< \brief Up-counting values loaded by the period match interrupt */
+  uint32 Direct;                  /**< \brief Up-counting values loaded directly in the down-counting part */
+  uint32 Critical;                /**< \brief Update closer than EMO_JIT_MARGIN to period or one match */
+  uint32 Missed;                  /**< \brief Deferred load not executed before the next FOC interrupt */
+  uint32 Overrun;                 /**< \brief Update after the one match of the next period */
+  uint16 StartPos;                /**< \brief Period position at entry of the FOC interrupt */
+  uint16 EndLast;                 /**< \brief Entry to update of the last period */
+  uint16 EndMax;                  /**< \brief Max. entry to update since reset */
+  uint16 MarginMin;               /**< \brief Min. distance of the update to the next transfer */
+  uint8 Pending;                  /**< \brief Deferred load requested */
+} TEmo_JitMon;
+
 
 
 /*******************************************************************************
@@ -291,10 +578,16 @@ extern TEmo_Status Emo_Status;
 extern  TEmo_Ctrl Emo_Ctrl;
 
 extern const TEmo_Focpar_Cfg Emo_Focpar_Cfg;
+extern const TEmo_SpeedSched_Cfg Emo_SpeedSched_Cfg[EMO_SPEED_SCHED_POINTS];
 extern TEmo_Foc Emo_Foc;
 extern uint32 Emo_AdcResult[4u];
 
 extern TEmo_Svm Emo_Svm;
+extern TEmo_Ident Emo_Ident;
+extern TEmo_Ipd Emo_Ipd;
+extern TEmo_LoadObs Emo_LoadObs;
+extern TEmo_RtMeas Emo_RtMeas[EMO_RT_NUM];
+extern TEmo_JitMon Emo_JitMon;
 
 /*******************************************************************************
 **                        Global Function Declarations                        **
@@ -305,6 +598,7 @@ extern uint16 speeduserreferenz;
 extern void Emo_HandleAdc1(void);
 extern void Emo_HandleFoc(void);
 extern void Emo_HandleT2Overflow(void);
+extern void Emo_HandleTrap(void);
 extern void Emo_InitFoc(void);
 
 extern void Emo_ExeSvmTest(TEmo_Svm *pSvm);
@@ -323,6 +617,162 @@ extern sint16 abs(sint16 inp);
 /*******************************************************************************
 **                     Global Inline Function Definitions                     **
 *******************************************************************************/
+#if (EMO_CFG_RUNTIME_MEAS_ENABLED == 1)
+/** \brief Starts the runtime measurement of a handler.
+ *
+ * \return SysTick counter value
+ */
+__STATIC_INLINE uint32 Emo_RtStart(void)
+{
+  return SysTick_Value_Get();
+} /* End of Emo_RtStart */
+
+
+/** \brief Stops the runtime measurement of a handler.
+ *
+ * \param Idx EMO_RT_x
+ * \param Start Return value of Emo_RtStart
+ * \return None
+ */
+__STATIC_INLINE void Emo_RtStop(uint32 Idx, uint32 Start)
+{
+  uint32 Stop;
+  uint32 Cycles;
+  TEmo_RtMeas *pMeas;
+  Stop = SysTick_Value_Get();
+
+  /* SysTick counts down, max. one reload within a handler */
+  if (Stop <= Start)
+  {
+    Cycles = Start - Stop;
+  }
+  else
+  {
+    Cycles = (Start + SysTick_ReloadValue_Get() + 1u) - Stop;
+  }
+
+  pMeas = &Emo_RtMeas[Idx];
+  pMeas->Calls++;
+  pMeas->CyclesLast = Cycles;
+  pMeas->CyclesSum += Cycles;
+
+  if (Cycles > pMeas->CyclesMax)
+  {
+    pMeas->CyclesMax = Cycles;
+  }
+} /* End of Emo_RtStop */
+#endif
+
+
+/** \brief Sets the T13 compare value of the ADC trigger.
+ *
+ * Same behavior as CCU6_SetT13Compare: the T13 period is increased if
+ * the compare value would not be reached. Only values from the
+ * configured period on are passed to the SDK function, as the period
+ * is never decreased, the period register is not read for all others.
+ *
+ * \param Compare T13 compare value
+ * \return None
+ */
+__STATIC_INLINE void Emo_PwmSetT13Compare(uint16 Compare)
+{
+#if (EMO_CFG_CCU6_FAST_UPDATE == 1)
+
+  if (Compare < (uint16)CCU6_T13PR)
+  {
+    CCU6->CC63SR.reg = Compare;
+  }
+  else
+  {
+    CCU6_SetT13Compare(Compare);
+  }
+
+#else
+  CCU6_SetT13Compare(Compare);
+#endif
+} /* End of Emo_PwmSetT13Compare */
+
+
+/** \brief Loads the compare values of the T12 down-counting part.
+ *
+ * \return None
+ */
+__STATIC_INLINE void Emo_PwmLoadDown(void)
+{
+#if (EMO_CFG_CCU6_FAST_UPDATE == 1)
+  CCU6->CC60SR.reg = Emo_Svm.comp60down;
+  CCU6->CC61SR.reg = Emo_Svm.comp61down;
+  CCU6->CC62SR.reg = Emo_Svm.comp62down;
+  /* TCTR4 bits are write only, other bits written as 0 have no effect */
+  CCU6->TCTR4.reg = (uint16)CCU6_TCTR4_T12STR_Msk;
+#else
+  CCU6_LoadShadowRegister_CC60(Emo_Svm.comp60down);
+  CCU6_LoadShadowRegister_CC61(Emo_Svm.comp61down);
+  CCU6_LoadShadowRegister_CC62(Emo_Svm.comp62down);
+  CCU6_EnableST_T12();
+#endif
+} /* End of Emo_PwmLoadDown */
+
+
+/** \brief Loads the compare values of the T12 up-counting part and the
+ *  T13 trigger of the first ADC measurement.
+ *
+ * \return None
+ */
+__STATIC_INLINE void Emo_PwmLoadUp(void)
+{
+#if (EMO_CFG_CCU6_FAST_UPDATE == 1)
+  CCU6->CC60SR.reg = Emo_Svm.comp60up;
+  CCU6->CC61SR.reg = Emo_Svm.comp61up;
+  CCU6->CC62SR.reg = Emo_Svm.comp62up;
+  CCU6->TCTR4.reg = (uint16)CCU6_TCTR4_T12STR_Msk;
+  CCU6->TCTR2.reg = (uint16)EMO_T13_TRIG_UP;
+#else
+  CCU6_LoadShadowRegister_CC60(Emo_Svm.comp60up);
+  CCU6_LoadShadowRegister_CC61(Emo_Svm.comp61up);
+  CCU6_LoadShadowRegister_CC62(Emo_Svm.comp62up);
+  CCU6_EnableST_T12();
+  CCU6_SetT13Trigger(EMO_T13_TRIG_UP);
+#endif
+  Emo_PwmSetT13Compare(Emo_Svm.CompT13ValueUp);
+} /* End of Emo_PwmLoadUp */
+
+
+/** \brief Loads the T13 trigger of the second ADC measurement.
+ *
+ * \return None
+ */
+__STATIC_INLINE void Emo_PwmLoadT13Down(void)
+{
+  Emo_PwmSetT13Compare(Emo_Svm.CompT13ValueDown);
+#if (EMO_CFG_CCU6_FAST_UPDATE == 1)
+  CCU6->TCTR2.reg = (uint16)EMO_T13_TRIG_DOWN;
+#else
+  CCU6_SetT13Trigger(EMO_T13_TRIG_DOWN);
+#endif
+} /* End of Emo_PwmLoadT13Down */
+
+#if (EMO_CFG_DCLINK_FAST == 1)
+/** \brief Filters the DC-link voltage and updates the compensation
+ *  factors, called every PWM period.
+ *
+ * \return None
+ */
+__STATIC_INLINE void Emo_DcLinkUpdate(void)
+{
+  uint32 Factor;
+  Emo_Foc.DcLinkVoltage = (uint16)Mat_ExeLp_without_min_max(&Emo_Foc.DcLinkLp, (sint16)ADC1->RES_OUT6.reg);
+  Factor = Mat_DivRecip(Emo_Foc.Kdcdivident1, Emo_Foc.DcLinkVoltage);
+
+  if (Factor > 0xFFFFu)
+  {
+    Factor = 0xFFFFu;
+  }
+
+  Emo_Foc.Dcfactor1 = (uint16)Factor;
+  Emo_Foc.Dcfactor2 = Mat_SsatCnt(Mat_FixMulScale(Emo_Foc.DcLinkVoltage, Emo_Foc.Kdcfactor2, 3), MAT_FIX_SAT, EMO_SAT_DCFACTOR);
+} /* End of Emo_DcLinkUpdate */
+#endif
 
 
 /** \brief Performs Limits Raumvektor algorithm.
@@ -415,8 +865,8 @@ __STATIC_INLINE TComplex Limitsvektorphase(TComplex *inp, TEmo_Svm *par)
   {
     btrfactor = par->MaxAmpQuadrat / (btrqu >> 15);
     btrfactor = 32500 - ((32767 - btrfactor) >> 1);
-    outp.Real = (sint16)(__SSAT(Mat_FixMulScale(inp->Real, btrfactor, 0), MAT_FIX_SAT));
-    outp.Imag = (sint16)(__SSAT(Mat_FixMulScale(inp->Imag, btrfactor, 0), MAT_FIX_SAT));
+    outp.Real = (sint16)(Mat_SsatCnt(Mat_FixMulScale(inp->Real, btrfactor, 0), MAT_FIX_SAT, EMO_SAT_LIMIT_VECT));
+    outp.Imag = (sint16)(Mat_SsatCnt(Mat_FixMulScale(inp->Imag, btrfactor, 0), MAT_FIX_SAT, EMO_SAT_LIMIT_VECT));
   }
   else
   {
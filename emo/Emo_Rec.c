@@ -0,0 +1,263 @@
+/*
+ ***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,are permitted provided that the
+ * following conditions are met:
+ *
+ *   Redistributions of source code must retain the above copyright notice, this list of conditions and the  following
+ *   disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *   following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *   Neither the name of the copyright holders nor the names of its contributors may be used to endorse or promote
+ *   products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE  FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY,OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT  OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **********************************************************************************************************************/
+
+#include "Emo_Rec.h"
+#include "uart_defines.h"
+
+#if (EMO_CFG_REC_ENABLED == 1)
+
+/*******************************************************************************
+**                        Private Function Declarations                       **
+*******************************************************************************/
+static uint8 Emo_lRecDumpByte(uint16 Pos);
+
+/*******************************************************************************
+**                         Global Variable Definitions                        **
+*******************************************************************************/
+TEmo_Rec Emo_Rec;
+
+/*******************************************************************************
+**                         Global Function Definitions                        **
+*******************************************************************************/
+/** \brief Initializes the flight recorder and UART2 for the dump.
+ *
+ * Baud rate and mode are taken from the Config Wizard settings of UART2
+ * (UART2_BRVAL, UART2_FD, UART2_SCON), the TxD pin has to be selected in
+ * the port configuration.
+ *
+ * \param None
+ * \return None
+ *
+ * \ingroup emo_api
+ */
+void Emo_RecInit(void)
+{
+  /* Baud rate generator 2 */
+  SCU->BCON2.reg = (uint8)0u;
+  SCU->BGL2.reg = (uint8)(((uint32)UART2_BRVAL << 5u) | (uint32)UART2_FD);
+  SCU->BGH2.reg = (uint8)((uint32)UART2_BRVAL >> 3u);
+  SCU->BCON2.bit.R = 1u;
+  UART2->SCON.reg = (uint8)UART2_SCON;
+  Emo_RecArm();
+} /* End of Emo_RecInit */
+
+
+/** \brief Clears the trigger and restarts the continuous recording.
+ *
+ * \param None
+ * \return None
+ *
+ * \ingroup emo_api
+ */
+void Emo_RecArm(void)
+{
+  Emo_Rec.Triggered = 0u;
+  Emo_Rec.Cause = EMO_REC_CAUSE_NONE;
+  Emo_Rec.DumpState = EMO_REC_DUMP_IDLE;
+  Emo_Rec.Remaining = EMO_CFG_REC_DEPTH;
+} /* End of Emo_RecArm */
+
+
+/** \brief Triggers the flight recorder.
+ *
+ * EMO_CFG_REC_POST periods are recorded after the trigger, then the
+ * ring buffer is frozen. Only the first cause after arm is stored.
+ *
+ * \param Cause EMO_REC_CAUSE_x
+ * \return None
+ *
+ * \ingroup emo_api
+ */
+void Emo_RecTrigger(uint16 Cause)
+{
+  if (Emo_Rec.Triggered == 0u)
+  {
+    Emo_Rec.Cause = Cause;
+    Emo_Rec.Remaining = EMO_CFG_REC_POST;
+    Emo_Rec.Triggered = 1u;
+  }
+} /* End of Emo_RecTrigger */
+
+
+/** \brief Triggers the flight recorder and freezes it immediately.
+ *
+ * Used by an explicit stop without pending trigger, the PWM is stopped
+ * and no further periods will be recorded.
+ *
+ * \param Cause EMO_REC_CAUSE_x
+ * \return None
+ *
+ * \ingroup emo_api
+ */
+void Emo_RecFreeze(uint16 Cause)
+{
+  Emo_RecTrigger(Cause);
+  Emo_Rec.Remaining = 0u;
+} /* End of Emo_RecFreeze */
+
+
+/** \brief Sends a frozen record via UART2, to be called cyclically.
+ *
+ * One byte is written per call when the transmit buffer is free, the
+ * function never waits. Records frozen by a normal stop are not sent.
+ *
+ * \param None
+ * \return None
+ *
+ * \ingroup emo_api
+ */
+void Emo_RecDump(void)
+{
+  uint8 Data;
+#if (EMO_CFG_SAT_COUNT_ENABLED == 1)
+  uint32 i;
+#endif
+
+  if (Emo_Rec.DumpState == EMO_REC_DUMP_IDLE)
+  {
+    if ((Emo_Rec.Triggered == 1u) && (Emo_Rec.Remaining == 0u) && (Emo_Rec.Cause != EMO_REC_CAUSE_STOP))
+    {
+      Emo_Rec.DumpPos = 0u;
+      Emo_Rec.DumpSum = 0u;
+      Emo_Rec.DumpState = EMO_REC_DUMP_RUN;
+#if (EMO_CFG_SAT_COUNT_ENABLED == 1)
+      /* counters are still counting in the FOC interrupt during the dump */
+      __disable_irq();
+
+      for (i = 0u; i < EMO_SAT_NUM; i++)
+      {
+        Emo_Rec.SatCount[i] = Emo_SatCount[i];
+      }
+
+      __enable_irq();
+#endif
+      /* first byte without waiting for TI */
+      UART2->SCONCLR.reg = (uint8)0x02u;
+      UART2->SBUF.reg = 0xA5u;
+    }
+  }
+  else if (Emo_Rec.DumpState == EMO_REC_DUMP_RUN)
+  {
+    if (UART2->SCON.bit.TI == 1u)
+    {
+      UART2->SCONCLR.reg = (uint8)0x02u;
+
+      if (Emo_Rec.DumpPos < ((EMO_REC_HEADER_SIZE - 1u) + (EMO_CFG_REC_DEPTH * sizeof(TEmo_RecEntry)) + EMO_REC_SAT_SIZE))
+      {
+        Data = Emo_lRecDumpByte(Emo_Rec.DumpPos);
+        Emo_Rec.DumpSum += Data;
+        Emo_Rec.DumpPos++;
+      }
+      else
+      {
+        /* checksum over all bytes after the sync byte */
+        Data = Emo_Rec.DumpSum;
+        Emo_Rec.DumpState = EMO_REC_DUMP_DONE;
+      }
+
+      UART2->SBUF.reg = Data;
+    }
+  }
+  else
+  {
+    /* EMO_REC_DUMP_DONE: wait for re-arm */
+  }
+} /* End of Emo_RecDump */
+
+/*******************************************************************************
+**                        Private Function Definitions                        **
+*******************************************************************************/
+/** \brief Returns one byte of the dump frame after the first sync byte.
+ *
+ * \param Pos Byte position
+ * \return Data byte
+ */
+static uint8 Emo_lRecDumpByte(uint16 Pos)
+{
+  uint8 Data;
+  uint16 Entry;
+  const uint8 *pData;
+
+  switch (Pos)
+  {
+    case 0u:
+      Data = 0x5Au;
+      break;
+
+    case 1u:
+      Data = (uint8)EMO_REC_VERSION;
+      break;
+
+    case 2u:
+      Data = (uint8)Emo_Rec.Cause;
+      break;
+
+    case 3u:
+      Data = (uint8)EMO_CFG_REC_DEPTH;
+      break;
+
+    case 4u:
+      Data = (uint8)sizeof(TEmo_RecEntry);
+      break;
+
+    default:
+    {
+      Pos = Pos - (EMO_REC_HEADER_SIZE - 1u);
+#if (EMO_CFG_SAT_COUNT_ENABLED == 1)
+
+      if (Pos >= (EMO_CFG_REC_DEPTH * sizeof(TEmo_RecEntry)))
+      {
+        /* number of saturation counters, counters little endian */
+        Pos = Pos - (EMO_CFG_REC_DEPTH * sizeof(TEmo_RecEntry));
+
+        if (Pos == 0u)
+        {
+          Data = (uint8)EMO_SAT_NUM;
+        }
+        else
+        {
+          pData = (const uint8 *)Emo_Rec.SatCount;
+          Data = pData[Pos - 1u];
+        }
+      }
+      else
+#endif
+      {
+        /* entries from oldest to newest, little endian */
+        Entry = (Emo_Rec.Index + (Pos / sizeof(TEmo_RecEntry))) & (EMO_CFG_REC_DEPTH - 1u);
+        pData = (const uint8 *)&Emo_Rec.Entry[Entry];
+        Data = pData[Pos % sizeof(TEmo_RecEntry)];
+      }
+    }
+    break;
+  }
+
+  return Data;
+} /* End of Emo_lRecDumpByte */
+
+#endif /* (EMO_CFG_REC_ENABLED == 1) */
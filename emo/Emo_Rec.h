@@ -0,0 +1,172 @@
+/*
+ ***********************************************************************************************************************
+ *
+ * Copyright (c) 2015, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,are permitted provided that the
+ * following conditions are met:
+ *
+ *   Redistributions of source code must retain the above copyright notice, this list of conditions and the  following
+ *   disclaimer.
+ *
+ *   Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *   following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *   Neither the name of the copyright holders nor the names of its contributors may be used to endorse or promote
+ *   products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE  FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY,OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT  OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ **********************************************************************************************************************/
+
+#ifndef EMO_REC_H
+#define EMO_REC_H
+
+/*******************************************************************************
+**                                  Includes                                  **
+*******************************************************************************/
+#include "Emo_RAM.h"
+
+/*******************************************************************************
+**                   Global Macro Definitions to be changed                   **
+*******************************************************************************/
+/* Flight recorder enable
+ * Range: 0=disabled, 1=enabled */
+#define EMO_CFG_REC_ENABLED (1)
+
+/* Number of recorded PWM periods, power of 2
+ * Range: 8..128, RAM = 20 Byte * EMO_CFG_REC_DEPTH */
+#define EMO_CFG_REC_DEPTH (32u)
+
+/* Number of PWM periods recorded after the trigger
+ * Range: 0..EMO_CFG_REC_DEPTH-1 */
+#define EMO_CFG_REC_POST (8u)
+
+/*******************************************************************************
+**             Derived Global Macro Definitions not to be changed             **
+*******************************************************************************/
+/* Trigger causes, first cause is kept until re-arm */
+#define EMO_REC_CAUSE_NONE        (0u)
+#define EMO_REC_CAUSE_STOP        (1u)
+#define EMO_REC_CAUSE_USER        (2u)
+#define EMO_REC_CAUSE_SECTOR      (3u)
+#define EMO_REC_CAUSE_BDRV_OC     (4u)
+#define EMO_REC_CAUSE_BDRV_VCP    (5u)
+#define EMO_REC_CAUSE_TRAP        (6u)
+
+/* Dump states */
+#define EMO_REC_DUMP_IDLE         (0u)
+#define EMO_REC_DUMP_RUN          (1u)
+#define EMO_REC_DUMP_DONE         (2u)
+
+/* Dump frame: sync 0xA5 0x5A, version, cause, depth, entry size, **
+** entries from oldest to newest, checksum                         **
+** version 2: saturation counters after the entries: number,       **
+** counters EMO_SAT_x little endian                                */
+#if (EMO_CFG_SAT_COUNT_ENABLED == 1)
+#define EMO_REC_VERSION           (2u)
+#define EMO_REC_SAT_SIZE          (1u + (2u * EMO_SAT_NUM))
+#else
+#define EMO_REC_VERSION           (1u)
+#define EMO_REC_SAT_SIZE          (0u)
+#endif
+#define EMO_REC_HEADER_SIZE       (6u)
+
+/*******************************************************************************
+**                           Global Type Definitions                          **
+*******************************************************************************/
+/** \brief Flight recorder entry, one per PWM period */
+typedef struct
+{
+  TPhaseCurr PhaseCurr;           /**< \brief Reconstructed phase currents */
+  TComplex RotCurr;               /**< \brief Rotating current (Id, Iq) */
+  uint16 Angle;                   /**< \brief FOC angle */
+  uint16 DcLinkVoltage;           /**< \brief DC-link voltage ADC value */
+  uint16 comp60up;                /**< \brief Compare value CC60 up-counting */
+  uint16 comp61up;                /**< \brief Compare value CC61 up-counting */
+  uint16 comp62up;                /**< \brief Compare value CC62 up-counting */
+  uint8 Sector;                   /**< \brief SVM sector */
+  uint8 MotorState;               /**< \brief Motor state */
+} TEmo_RecEntry;
+
+/** \brief Flight recorder status */
+typedef struct
+{
+  uint16 Index;                   /**< \brief Next entry to be written = oldest entry */
+  uint16 Remaining;               /**< \brief Entries to be written until freeze */
+  uint16 Triggered;               /**< \brief Trigger occurred since arm */
+  uint16 StopPending;             /**< \brief Fault stop, PWM stopped after the post-trigger periods */
+  uint16 Cause;                   /**< \brief First trigger cause */
+  uint16 DumpState;               /**< \brief State of UART dump */
+  uint16 DumpPos;                 /**< \brief Next byte of UART dump */
+  uint8 DumpSum;                  /**< \brief Checksum of UART dump */
+  TEmo_RecEntry Entry[EMO_CFG_REC_DEPTH];
+#if (EMO_CFG_SAT_COUNT_ENABLED == 1)
+  uint16 SatCount[EMO_SAT_NUM];   /**< \brief Saturation counters at start of UART dump */
+#endif
+} TEmo_Rec;
+
+/*******************************************************************************
+**                        Global Variable Declarations                        **
+*******************************************************************************/
+extern TEmo_Rec Emo_Rec;
+
+/*******************************************************************************
+**                        Global Function Declarations                        **
+*******************************************************************************/
+extern void Emo_RecInit(void);
+extern void Emo_RecArm(void);
+extern void Emo_RecTrigger(uint16 Cause);
+extern void Emo_RecFreeze(uint16 Cause);
+extern void Emo_RecDump(void);
+__STATIC_INLINE void Emo_RecCapture(void);
+
+/*******************************************************************************
+**                     Global Inline Function Definitions                     **
+*******************************************************************************/
+/** \brief Stores the snapshot of the current PWM period.
+ *
+ * Called at the end of Emo_HandleFoc. Before the trigger Remaining is not
+ * decremented (Triggered = 0), after the trigger EMO_CFG_REC_POST entries
+ * are written, then the ring buffer is frozen. After a fault stop the PWM
+ * runs on with the bridge off until the post-trigger entries are written.
+ * Cost: 9 loads and 9 stores of the entry plus index and counter update,
+ * about 50 cycles (2.5% of the 2000 cycle PWM period) counted from the
+ * instruction sequence; measured in Emo_RtMeas[EMO_RT_REC]. Below 20
+ * cycles only currents and angle would fit, without the compare values,
+ * sector and state a fault of the modulation cannot be reconstructed.
+ *
+ * \param None
+ * \return None
+ *
+ * \ingroup emo_api
+ */
+__STATIC_INLINE void Emo_RecCapture(void)
+{
+  TEmo_RecEntry *pEntry;
+
+  if (Emo_Rec.Remaining != 0u)
+  {
+    pEntry = &Emo_Rec.Entry[Emo_Rec.Index];
+    pEntry->PhaseCurr = Emo_Svm.PhaseCurr;
+    pEntry->RotCurr = Emo_Foc.RotCurr;
+    pEntry->Angle = Emo_Foc.Angle;
+    pEntry->DcLinkVoltage = Emo_Foc.DcLinkVoltage;
+    pEntry->comp60up = Emo_Svm.comp60up;
+    pEntry->comp61up = Emo_Svm.comp61up;
+    pEntry->comp62up = Emo_Svm.comp62up;
+    pEntry->Sector = (uint8)Emo_Svm.Sector;
+    pEntry->MotorState = Emo_Status.MotorState;
+    Emo_Rec.Index = (Emo_Rec.Index + 1u) & (EMO_CFG_REC_DEPTH - 1u);
+    Emo_Rec.Remaining -= Emo_Rec.Triggered;
+  }
+} /* End of Emo_RecCapture */
+
+#endif /* EMO_REC_H */
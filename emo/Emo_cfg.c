@@ -102,5 +102,20 @@ const TEmo_Focpar_Cfg Emo_Focpar_Cfg =
   (float) FOC_CUR_ADJUST,
   /* Maximum Speed */
   (float) FOC_MAX_SPEED,
+  /* Kp of flux angle PLL */
+  (uint16) FOC_PLL_KP,
 };/* End of Emo_Focpar_Cfg */
 
+#if (EMO_CFG_SPEED_SCHED_ENABLED == 1)
+const TEmo_SpeedSched_Cfg Emo_SpeedSched_Cfg[EMO_SPEED_SCHED_POINTS] =
+{
+  /* Speed in 1/rpm, Kp, Ki, MaxRefCurr in A, MinRefCurr in A */
+  /* start current limits up to the speed level */
+  {(float) 0, (uint16) FOC_SPEED_KP, (uint16) FOC_SPEED_KI, (float) FOC_MIN_POS_REF_CUR, (float) FOC_MIN_NEG_REF_CUR},
+  {(float) FOC_MAX_CUR_SPEED, (uint16) FOC_SPEED_KP, (uint16) FOC_SPEED_KI, (float) FOC_MIN_POS_REF_CUR, (float) FOC_MIN_NEG_REF_CUR},
+  /* full current limits above */
+  {(float) (FOC_MAX_CUR_SPEED * 1.2), (uint16) FOC_SPEED_KP, (uint16) FOC_SPEED_KI, (float) FOC_MAX_POS_REF_CUR, (float) FOC_MAX_NEG_REF_CUR},
+  {(float) FOC_MAX_SPEED, (uint16) FOC_SPEED_KP, (uint16) FOC_SPEED_KI, (float) FOC_MAX_POS_REF_CUR, (float) FOC_MAX_NEG_REF_CUR},
+};/* End of Emo_SpeedSched_Cfg */
+#endif
+
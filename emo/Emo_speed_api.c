@@ -55,6 +55,11 @@
 
 void Emo_setspeedreferenz(uint16 speedreferenz)
 {
+#if (EMO_CFG_TRAJ_ENABLED == 1)
+  /* reference speed follows in Emo_HandleT2Overflow */
+  Emo_Ctrl.CmdSpeed = speedreferenz;
+#else
   Emo_Ctrl.RefSpeed = speedreferenz;
+#endif
 }
 
@@ -68,6 +68,17 @@
 /* (1 / sqrt(3)) in fixed-point format */
 #define MAT_ONE_OVER_SQRT_3 (18919u)
 
+/* Function-like macros to saturate with an event counter per call site (Site = EMO_SAT_x)
+ * and to count a limitation, plain __SSAT without EMO_CFG_SAT_COUNT_ENABLED.
+ * When counting, Value is evaluated twice and must be free of side effects. */
+#if (EMO_CFG_SAT_COUNT_ENABLED == 1)
+#define Mat_SsatCnt(Value, Bits, Site) Mat_lSatCnt(__SSAT((Value), (Bits)), (sint32)(Value), (Site))
+#define Mat_SatEvent(Site) ((void)Mat_lSatCnt(0, 1, (Site)))
+#else
+#define Mat_SsatCnt(Value, Bits, Site) __SSAT((Value), (Bits))
+#define Mat_SatEvent(Site)
+#endif
+
 /*******************************************************************************
 **                           Global Type Definitions                          **
 *******************************************************************************/
@@ -81,6 +92,9 @@ typedef struct
   sint16 IMax;     /**< \brief Maximum for I output */
   sint16 PiMin;    /**< \brief Minimum for PI output */
   sint16 PiMax;    /**< \brief Maximum for PI output */
+#if (EMO_CFG_SAT_COUNT_ENABLED == 1)
+  uint16 SatSite;  /**< \brief Saturation counters: I limit, P part, PI limit */
+#endif
 } TMat_Pi;
 
 typedef struct
@@ -94,6 +108,9 @@ typedef struct
   sint16 IMax;     /**< \brief Maximum for I output */
   sint16 PiMin;    /**< \brief Minimum for PI output */
   sint16 PiMax;    /**< \brief Maximum for PI output */
+#if (EMO_CFG_SAT_COUNT_ENABLED == 1)
+  uint16 SatSite;  /**< \brief Saturation counters: I limit, P part, PI limit */
+#endif
 } TMat_Pi_Windup;
 
 /** \brief low pass status */
@@ -120,9 +137,17 @@ typedef struct
 *******************************************************************************/
 
 /* Inline functions ***********************************************************/
+#if (EMO_CFG_SAT_COUNT_ENABLED == 1)
+__STATIC_INLINE sint32 Mat_lSatCnt(sint32 Sat, sint32 Value, uint32 Site);
+#endif
 __STATIC_INLINE sint16 Mat_ExePi(TMat_Pi *pPi, sint16 Error);
 __STATIC_INLINE sint16 Mat_ExePi_Windup(TMat_Pi_Windup *pPi, sint16 Error);
 __STATIC_INLINE TComplex Mat_Clarke(TPhaseCurr PhaseCurr);
+__STATIC_INLINE uint32 Mat_DivRecip(uint32 Num, uint16 Den);
+#if (EMO_CFG_TABLE_QUARTERWAVE == 1)
+__STATIC_INLINE sint32 Mat_lSinQuarter(uint32 UAngle);
+#endif
+__STATIC_INLINE void Mat_GetSinCos(uint32 UAngle, sint32 *pSin, sint32 *pCos);
 __STATIC_INLINE TComplex Mat_Park(TComplex StatCurr, uint16 Angle);
 __STATIC_INLINE TComplex Mat_InvPark(TComplex RotVolt, uint16 Angle);
 __STATIC_INLINE TComplex Mat_PolarKartesisch(uint16 Amp, uint16 Angle);
@@ -136,6 +161,29 @@ __STATIC_INLINE sint16 Mat_Ramp(sint16 Input, sint32 Slewrate, sint32 *Output);
 /*******************************************************************************
 **                     Global Inline Function Definitions                     **
 *******************************************************************************/
+#if (EMO_CFG_SAT_COUNT_ENABLED == 1)
+/** \brief Counts a saturation event of a call site.
+ *
+ * The counter stops at 0xFFFF, see Emo_SatReset.
+ *
+ * \param[in] Sat Saturated value
+ * \param[in] Value Value before saturation
+ * \param[in] Site Call site EMO_SAT_x
+ *
+ * \return Saturated value
+ * \ingroup math_api
+ */
+__STATIC_INLINE sint32 Mat_lSatCnt(sint32 Sat, sint32 Value, uint32 Site)
+{
+  if ((Sat != Value) && (Emo_SatCount[Site] < 0xFFFFu))
+  {
+    Emo_SatCount[Site]++;
+  }
+
+  return Sat;
+} /* End of Mat_lSatCnt */
+#endif
+
 /** \brief Performs PI control algorithm.
  *
  * \param[inout] pPi Pointer to PI status
@@ -159,6 +207,7 @@ __STATIC_INLINE sint16 Mat_ExePi(TMat_Pi *pPi, sint16 Error)
   if (IOut < Min)
   {
     IOut = Min;
+    Mat_SatEvent(pPi->SatSite);
   }
   else
   {
@@ -167,13 +216,14 @@ __STATIC_INLINE sint16 Mat_ExePi(TMat_Pi *pPi, sint16 Error)
     if (IOut > Max)
     {
       IOut = Max;
+      Mat_SatEvent(pPi->SatSite);
     }
   }
 
   /* Store I output */
   pPi->IOut = IOut;
   /* PI output = upper half of (I output + saturate(error * P parameter) * 64) */
-  Temp = __SSAT(Error * ((sint32)pPi->Kp), 31u - 6u);
+  Temp = Mat_SsatCnt(Error * ((sint32)pPi->Kp), 31u - 6u, pPi->SatSite + 1u);
   PiOut = (IOut + (Temp << 6u)) >> 15u;
   /* Limit PI output */
   Min = (sint32)(pPi->PiMin);
@@ -181,6 +231,7 @@ __STATIC_INLINE sint16 Mat_ExePi(TMat_Pi *pPi, sint16 Error)
   if (PiOut < Min)
   {
     PiOut = Min;
+    Mat_SatEvent(pPi->SatSite + 2u);
   }
   else
   {
@@ -189,6 +240,7 @@ __STATIC_INLINE sint16 Mat_ExePi(TMat_Pi *pPi, sint16 Error)
     if (PiOut > Max)
     {
       PiOut = Max;
+      Mat_SatEvent(pPi->SatSite + 2u);
     }
   }
 
@@ -218,6 +270,7 @@ __STATIC_INLINE sint16 Mat_ExePi_Windup(TMat_Pi_Windup *pPi, sint16 Error)
   if (IOut < Min)
   {
     IOut = Min;
+    Mat_SatEvent(pPi->SatSite);
   }
   else
   {
@@ -226,13 +279,14 @@ __STATIC_INLINE sint16 Mat_ExePi_Windup(TMat_Pi_Windup *pPi, sint16 Error)
     if (IOut > Max)
     {
       IOut = Max;
+      Mat_SatEvent(pPi->SatSite);
     }
   }
 
   /* Store I output */
   pPi->IOut = IOut;
   /* PI output = upper half of (I output + saturate(error * P parameter) * 64) */
-  Temp = __SSAT(Error * ((sint32)pPi->Kp), 31u - 6u);
+  Temp = Mat_SsatCnt(Error * ((sint32)pPi->Kp), 31u - 6u, pPi->SatSite + 1u);
   PiOut = (IOut + (Temp << 6u)) >> 15u;
   pPi->Dout = PiOut;
   /* Limit PI output */
@@ -241,6 +295,7 @@ __STATIC_INLINE sint16 Mat_ExePi_Windup(TMat_Pi_Windup *pPi, sint16 Error)
   if (PiOut < Min)
   {
     PiOut = Min;
+    Mat_SatEvent(pPi->SatSite + 2u);
   }
   else
   {
@@ -249,6 +304,7 @@ __STATIC_INLINE sint16 Mat_ExePi_Windup(TMat_Pi_Windup *pPi, sint16 Error)
     if (PiOut > Max)
     {
       PiOut = Max;
+      Mat_SatEvent(pPi->SatSite + 2u);
     }
   }
 
@@ -272,7 +328,7 @@ __STATIC_INLINE sint16 Mat_ExeLp(TMat_Lp *pLp, sint16 Input)
   sint32 Max;
   /* New output = saturate(old output + coefficient A * input - coefficient B * old output/2^15 */
   Out = pLp->Out;
-  Out = __SSAT((Out + ((sint32)pLp->CoefA * (sint32)Input)) - ((sint32)pLp->CoefB * (Out >> 15u)), 31u);
+  Out = Mat_SsatCnt((Out + ((sint32)pLp->CoefA * (sint32)Input)) - ((sint32)pLp->CoefB * (Out >> 15u)), 31u, EMO_SAT_LP);
   /* Limit new output */
   Min = ((sint32)(pLp->Min)) << 15u;
 
@@ -310,13 +366,42 @@ __STATIC_INLINE sint16 Mat_ExeLp_without_min_max(TMat_Lp_Simple *pLp, sint16 Inp
   sint32 Out;
   /* New output = saturate(old output + coefficient A * input - coefficient B * old output/2^15 */
   Out = pLp->Out;
-  Out = __SSAT((Out + ((sint32)pLp->CoefA * (sint32)Input)) - ((sint32)pLp->CoefB * (Out >> 15u)), 31u);
+  Out = Mat_SsatCnt((Out + ((sint32)pLp->CoefA * (sint32)Input)) - ((sint32)pLp->CoefB * (Out >> 15u)), 31u, EMO_SAT_LP);
   /* Store new output */
   pLp->Out = Out;
   /* return upper part */
   return (sint16)(Out >> 15u);
 } /* End of Mat_ExeLp */
 
+/** \brief Divides without hardware division.
+ *
+ * The reciprocal of the normalized divisor is taken from a table and
+ * refined by one Newton-Raphson step, result is rounded down with a
+ * relative error < 1e-4. Like the hardware division, 0 is returned
+ * for a divisor of 0.
+ *
+ * \param[in] Num Dividend
+ * \param[in] Den Divisor
+ * \return Num / Den
+ *
+ * \ingroup math_api
+ */
+__STATIC_INLINE uint32 Mat_DivRecip(uint32 Num, uint16 Den)
+{
+  uint32 Shift;
+  uint32 Norm;
+  uint32 Recip;
+  /* Normalize divisor to 0x8000..0xFFFF (0.5..1) */
+  Shift = __CLZ((uint32)Den) - 16u;
+  Norm = (uint32)Den << Shift;
+  /* Seed 1/Norm in Q15 */
+  Recip = Table_Recip[(Norm >> 9u) & (TABLE_SIZE_RECIP - 1u)];
+  /* Newton step: Recip * (2 - Norm * Recip) in Q30 */
+  Recip = (uint32)(((uint64)Recip * (uint32)(0u - (Norm * Recip))) >> 16u);
+  /* Num * Recip, scaled back by the normalization */
+  return (uint32)(((uint64)Num * Recip) >> (46u - Shift));
+} /* End of Mat_DivRecip */
+
 /** \brief Performs the Clarke transformation.
  *
  * \param[in] PhaseCurr 3-phase current structure
@@ -328,13 +413,59 @@ __STATIC_INLINE TComplex Mat_Clarke(TPhaseCurr PhaseCurr)
 {
   TComplex StatCurr = {0, 0};
   /* Real current = saturate(4 * Ia) */
-  StatCurr.Real = __SSAT(4 * PhaseCurr.A, MAT_FIX_SAT);
+  StatCurr.Real = Mat_SsatCnt(4 * PhaseCurr.A, MAT_FIX_SAT, EMO_SAT_CLARKE);
   /* Imag. current = saturate(1 / sqrt(3)) * 4 * (Ia + 2 * Ib) */
-  StatCurr.Imag = (sint16)__SSAT(Mat_FixMulScale(MAT_ONE_OVER_SQRT_3, ((sint32)PhaseCurr.A) + (2 * ((sint32)PhaseCurr.B)), 2), MAT_FIX_SAT);
+  StatCurr.Imag = (sint16)Mat_SsatCnt(Mat_FixMulScale(MAT_ONE_OVER_SQRT_3, ((sint32)PhaseCurr.A) + (2 * ((sint32)PhaseCurr.B)), 2), MAT_FIX_SAT, EMO_SAT_CLARKE);
   return StatCurr;
 } /* End of Mat_Clarke */
 
 
+#if (EMO_CFG_TABLE_QUARTERWAVE == 1)
+/** \brief Gets the sine from the quarter wave table by quadrant folding.
+ *
+ * \param[in] UAngle Angle [0..1023 = 0..2Pi]
+ * \return Sine [-32767..32767]
+ *
+ * \ingroup math_api
+ */
+__STATIC_INLINE sint32 Mat_lSinQuarter(uint32 UAngle)
+{
+  uint32 Mirror;
+  uint32 Index;
+  sint32 Sign;
+  sint32 Value;
+  /* 2nd and 4th quarter: mirrored index 256 - index, without branch */
+  Mirror = 0u - ((UAngle >> 8u) & 1u);
+  Index = (((UAngle & 0xFFu) ^ Mirror) - Mirror) + (Mirror & (TABLE_SIZE_SIN_COS / 4u));
+  Value = Table_SinQuarter[Index];
+  /* 3rd and 4th quarter: negative value, without branch */
+  Sign = -(sint32)((UAngle >> 9u) & 1u);
+  return (Value ^ Sign) - Sign;
+} /* End of Mat_lSinQuarter */
+#endif
+
+
+/** \brief Gets sine and cosine from the sine table.
+ *
+ * \param[in] UAngle Angle [0..1023 = 0..2Pi]
+ * \param[out] pSin Sine [-32767..32767]
+ * \param[out] pCos Cosine [-32767..32767]
+ * \return None
+ *
+ * \ingroup math_api
+ */
+__STATIC_INLINE void Mat_GetSinCos(uint32 UAngle, sint32 *pSin, sint32 *pCos)
+{
+#if (EMO_CFG_TABLE_QUARTERWAVE == 1)
+  *pSin = Mat_lSinQuarter(UAngle);
+  *pCos = Mat_lSinQuarter((UAngle + (TABLE_SIZE_SIN_COS / 4u)) & (TABLE_SIZE_SIN_COS - 1u));
+#else
+  *pSin = Table_Sin[UAngle];
+  *pCos = pTable_Cos[UAngle];
+#endif
+} /* End of Mat_GetSinCos */
+
+
 /** \brief Performs the Park transformation.
  *
  * \param[in] StatCurr Stationary 2-phase current structure
@@ -352,12 +483,11 @@ __STATIC_INLINE TComplex Mat_Park(TComplex StatCurr, uint16 Angle)
   /* Take upper 10 bits of 16-bit angle */
   UAngle = Angle >> 6u;
   /* Get angle functions */
-  Cos = pTable_Cos[UAngle];
-  Sin = Table_Sin[UAngle];
+  Mat_GetSinCos(UAngle, &Sin, &Cos);
   /* Real output = saturate(real input * cos + imag. input * sin) */
-  RotCurrent.Real = (sint16)__SSAT(Mat_FixMul(StatCurr.Real, Cos) + Mat_FixMul(StatCurr.Imag, Sin), MAT_FIX_SAT);
+  RotCurrent.Real = (sint16)Mat_SsatCnt(Mat_FixMul(StatCurr.Real, Cos) + Mat_FixMul(StatCurr.Imag, Sin), MAT_FIX_SAT, EMO_SAT_PARK);
   /* Imag. output = saturate(imag. input * cos - real input * sin) */
-  RotCurrent.Imag = (sint16)__SSAT(Mat_FixMul(StatCurr.Imag, Cos) - Mat_FixMul(StatCurr.Real, Sin), MAT_FIX_SAT);
+  RotCurrent.Imag = (sint16)Mat_SsatCnt(Mat_FixMul(StatCurr.Imag, Cos) - Mat_FixMul(StatCurr.Real, Sin), MAT_FIX_SAT, EMO_SAT_PARK);
   return RotCurrent;
 } /* End of Mat_Park */
 
@@ -379,12 +509,11 @@ __STATIC_INLINE TComplex Mat_InvPark(TComplex RotVolt, uint16 Angle)
   /* Take upper 10 bits of 16-bit angle */
   UAngle = Angle >> 6u;
   /* Get angle functions */
-  Cos = pTable_Cos[UAngle];
-  Sin = Table_Sin[UAngle];
+  Mat_GetSinCos(UAngle, &Sin, &Cos);
   /* Real output = saturate(real input * cos / 4 - imag. input * sin / 4) */
-  StatVolt.Real = (sint16)(__SSAT(Mat_FixMulScale(RotVolt.Real, Cos, -2) - Mat_FixMulScale(RotVolt.Imag, Sin, -2), MAT_FIX_SAT));
+  StatVolt.Real = (sint16)(Mat_SsatCnt(Mat_FixMulScale(RotVolt.Real, Cos, -2) - Mat_FixMulScale(RotVolt.Imag, Sin, -2), MAT_FIX_SAT, EMO_SAT_INV_PARK));
   /* Imaginary output = saturate(real input * sin / 4 + imag. input * cos / 4) */
-  StatVolt.Imag = (sint16)(__SSAT(Mat_FixMulScale(RotVolt.Real, Sin, -2) + Mat_FixMulScale(RotVolt.Imag, Cos, -2), MAT_FIX_SAT));
+  StatVolt.Imag = (sint16)(Mat_SsatCnt(Mat_FixMulScale(RotVolt.Real, Sin, -2) + Mat_FixMulScale(RotVolt.Imag, Cos, -2), MAT_FIX_SAT, EMO_SAT_INV_PARK));
   return StatVolt;
 } /* End of Mat_InvPark */
 
@@ -405,12 +534,11 @@ __STATIC_INLINE TComplex Mat_PolarKartesisch(uint16 Amp, uint16 Angle)
   /* Take upper 10 bits of 16-bit angle */
   UAngle = Angle >> 6u;
   /* Get angle functions */
-  Cos = pTable_Cos[UAngle];
-  Sin = Table_Sin[UAngle];
+  Mat_GetSinCos(UAngle, &Sin, &Cos);
   /* Real output = saturate(real input * cos / 4 - imag. input * sin / 4) */
-  StatOut.Real = (sint16)(__SSAT(Mat_FixMulScale(Amp, Cos, 0), MAT_FIX_SAT));
+  StatOut.Real = (sint16)(Mat_SsatCnt(Mat_FixMulScale(Amp, Cos, 0), MAT_FIX_SAT, EMO_SAT_POLAR));
   /* Imaginary output = saturate(real input * sin / 4 + imag. input * cos / 4) */
-  StatOut.Imag = (sint16)(__SSAT(Mat_FixMulScale(Amp, Sin, 0), MAT_FIX_SAT));
+  StatOut.Imag = (sint16)(Mat_SsatCnt(Mat_FixMulScale(Amp, Sin, 0), MAT_FIX_SAT, EMO_SAT_POLAR));
   return StatOut;
 } /* End of Mat_PolarKartesisch */
 
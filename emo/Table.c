@@ -53,7 +53,11 @@
 /*******************************************************************************
 **                         Global Constant Definitions                        **
 *******************************************************************************/
+#if (EMO_CFG_TABLE_QUARTERWAVE == 1)
+const sint16 Table_SinQuarter[(TABLE_SIZE_SIN_COS / 4u) + 1u] =
+#else
 const sint16 Table_Sin[TABLE_SIZE_SIN_COS + (TABLE_SIZE_SIN_COS / 4u)] =
+#endif
 {
   0, 201, 402, 603, 804, 1005, 1206, 1407,
   1608, 1809, 2009, 2210, 2411, 2611, 2811, 3012,
@@ -87,6 +91,9 @@ const sint16 Table_Sin[TABLE_SIZE_SIN_COS + (TABLE_SIZE_SIN_COS / 4u)] =
   32413, 32442, 32470, 32496, 32522, 32546, 32568, 32590,
   32610, 32629, 32647, 32664, 32679, 32693, 32706, 32718,
   32729, 32738, 32746, 32753, 32758, 32762, 32766, 32767,
+#if (EMO_CFG_TABLE_QUARTERWAVE == 1)
+  32767
+#else
   32767, 32767, 32766, 32762, 32758, 32753, 32746, 32738,
   32729, 32718, 32706, 32693, 32679, 32664, 32647, 32629,
   32610, 32590, 32568, 32546, 32522, 32496, 32470, 32442,
@@ -215,6 +222,7 @@ const sint16 Table_Sin[TABLE_SIZE_SIN_COS + (TABLE_SIZE_SIN_COS / 4u)] =
   32413, 32442, 32470, 32496, 32522, 32546, 32568, 32590,
   32610, 32629, 32647, 32664, 32679, 32693, 32706, 32718,
   32729, 32738, 32746, 32753, 32758, 32762, 32766, 32767
+#endif
 }; /* End of Table_Sin */
 
 
@@ -593,5 +601,37 @@ const uint16 Table_Sin60[] =
   , Table_lScale(28106), Table_lScale(28174), Table_lScale(28242), Table_lScale(28310)
 };
 
+/* Reciprocal seed for Mat_DivRecip: 1/x in Q15 at the middle of the  **
+** intervals x = 0.5..1 in steps of 1/128                              */
+const uint16 Table_Recip[TABLE_SIZE_RECIP] =
+{
+  65028u, 64035u, 63072u, 62138u, 61231u, 60350u, 59494u, 58662u,
+  57852u, 57065u, 56299u, 55554u, 54828u, 54120u, 53431u, 52759u,
+  52103u, 51464u, 50840u, 50231u, 49637u, 49056u, 48489u, 47935u,
+  47393u, 46864u, 46346u, 45839u, 45344u, 44859u, 44384u, 43919u,
+  43464u, 43019u, 42582u, 42154u, 41734u, 41323u, 40920u, 40525u,
+  40137u, 39756u, 39383u, 39017u, 38657u, 38304u, 37958u, 37617u,
+  37283u, 36954u, 36631u, 36314u, 36003u, 35696u, 35395u, 35099u,
+  34808u, 34521u, 34239u, 33962u, 33689u, 33421u, 33157u, 32897u
+};  /* End of Table_Recip */
+
+#if (EMO_CFG_SVM_OVERMOD == 1)
+/* Overmodulation region I: amplitude stretch A / MaxAmp - 1 in Q15 for  **
+** the fundamental MaxAmp..OvmAmp2 in 8 equal steps                      */
+const uint16 Table_OvmStretch[TABLE_SIZE_OVM] =
+{
+  0u, 268u, 590u, 967u, 1411u, 1944u, 2608u, 3504u, 5069u
+};  /* End of Table_OvmStretch */
+
+/* Overmodulation region II: hold index (of 256 per sector) for the     **
+** fundamental OvmAmp2..MaxAmpOvm in 8 equal steps                       */
+const uint16 Table_OvmHold[TABLE_SIZE_OVM] =
+{
+  0u, 8u, 17u, 27u, 38u, 50u, 64u, 83u, 128u
+};  /* End of Table_OvmHold */
+#endif
+
+#if (EMO_CFG_TABLE_QUARTERWAVE == 0)
 const sint16 *pTable_Cos = Table_Sin + (TABLE_SIZE_SIN_COS / 4u);
+#endif
 
@@ -54,16 +54,29 @@
 **                          Global Macro Definitions                          **
 *******************************************************************************/
 #define TABLE_SIZE_SIN_COS (1024u)
+#define TABLE_SIZE_RECIP (64u)
+#define TABLE_SIZE_OVM (9u)
 
 /*******************************************************************************
 **                        Global Constant Declarations                        **
 *******************************************************************************/
+#if (EMO_CFG_TABLE_QUARTERWAVE == 1)
+extern const sint16 Table_SinQuarter[];
+#else
 extern const sint16 Table_Sin[];
+#endif
 extern const uint16 Table_ArcTan[];
 extern const uint16 Table_Amp[];
 extern const uint16 Table_Sin60[];
+#if (EMO_CFG_TABLE_QUARTERWAVE == 0)
 extern const sint16 *pTable_Cos;
+#endif
 extern const uint16 Table_sqrtmqu[];
+extern const uint16 Table_Recip[];
+#if (EMO_CFG_SVM_OVERMOD == 1)
+extern const uint16 Table_OvmStretch[];
+extern const uint16 Table_OvmHold[];
+#endif
 
 #endif /* TABLE_H */
 
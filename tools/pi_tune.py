@@ -0,0 +1,432 @@
+#!/usr/bin/env python3
+"""Automatic gain tuner for the current, speed and flux angle PLL controllers.
+
+The gains FOC_CUR_ADJUST, FOC_SPEED_KP, FOC_SPEED_KI and FOC_PLL_KP are
+optimized with Nelder-Mead (in log space) on a host model of the closed loop.
+Several optimizer runs with different start points are executed in parallel,
+each one on its own process of the pool. The result is printed as a
+foc_defines.h fragment and can be written to the Config Wizard project
+(--icwp), so a regeneration of foc_defines.h keeps it.
+
+Model, one step per PWM period:
+  - PMSM in rotor coordinates, Ld = Lq, Euler integration with sub-steps
+  - current regulators as in Emo_lInitFocPar / Mat_ExePi: pole-zero
+    cancellation, integer Kp/Ki from FOC_CUR_ADJUST, one period delay of
+    the voltage, output limited to the inscribed circle Udc/sqrt(3)
+  - flux angle = true angle + noise, PLL as Emo_FluxAnglePll with the
+    speed feed-forward over Anglersptr periods
+  - speed from the angle difference over Anglersptr periods and the speed
+    low-pass FOC_SPEED_FILT_TIME, speed regulator every T2 period
+  - white noise on the measured phase currents
+Flux estimator dynamics, SVM and deadtime are not modeled.
+
+Test sequence of each evaluation:
+  1. locked rotor, iq step to half of FOC_MAX_POS_REF_CUR
+  2. closed loop at FOC_END_START_SPEED, speed step to --speed, then a
+     load torque step (--load, part of the torque at FOC_MAX_POS_REF_CUR)
+Objectives, weighted sum:
+  rise      current rise time / 1 ms + speed rise time / 100 ms
+  overshoot current and speed overshoot + speed dip after the load step
+            (parts of the step)
+  ripple    speed ripple / speed + iq ripple / FOC_MAX_POS_REF_CUR at
+            the end of the sequence
+
+Usage:
+  pi_tune.py --psi 0.004 --inertia 2e-5
+  pi_tune.py --psi 0.004 --inertia 2e-5 --starts 8 --jobs 8 --icwp
+"""
+
+import argparse
+import math
+import multiprocessing
+import os
+import random
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+RTE = os.path.join(HERE, "..", "RTE", "Device", "TLE9879QXA40")
+
+# firmware constants (Emo_lInitFocPar)
+KU = 15.0
+CURR_STEP_TIME = 0.01
+SPEED_STEP_AT = 0.05
+
+# tuned gains: define, lower and upper bound, decimals (0 = integer)
+GAINS = (
+    ("CUR_ADJUST", 0.01, 1.0, 2),
+    ("SPEED_KP", 1, 32767, 0),
+    ("SPEED_KI", 1, 32767, 0),
+    ("PLL_KP", 1, 32767, 0),
+)
+
+RE_DEFINE = re.compile(r"^#define\s+(\w+)\s+\(([^)]+)\)")
+
+
+def read_defines(path):
+    """Returns the numeric defines of a Config Wizard header."""
+    defines = {}
+    with open(path) as f:
+        for line in f:
+            m = RE_DEFINE.match(line)
+            if m:
+                try:
+                    defines[m.group(1)] = float(int(m.group(2), 0)) if m.group(2).startswith("0x") else float(m.group(2))
+                except ValueError:
+                    pass
+    return defines
+
+
+class Motor(object):
+    """Motor, inverter and firmware parameters of the model."""
+
+    def __init__(self, foc, args, pwm_freq, t2_period):
+        self.r = foc["FOC_R_PHASE"]
+        self.l = foc["FOC_L_PHASE"]
+        self.p = int(foc["FOC_POLE_PAIRS"])
+        self.f = pwm_freq
+        self.t2 = t2_period
+        self.psi = args.psi
+        self.j = args.inertia
+        self.b = args.friction
+        self.udc = args.udc
+        self.imax = foc["FOC_MAX_POS_REF_CUR"]
+        self.speed0 = foc["FOC_END_START_SPEED"]
+        self.speed1 = args.speed if args.speed else 0.75 * foc["FOC_MAX_SPEED"]
+        self.tload = args.load * 1.5 * self.p * self.psi * self.imax
+        self.filt = foc["FOC_SPEED_FILT_TIME"]
+        self.time = args.time
+        self.noise_i = args.noise_curr
+        self.noise_angle = math.radians(args.noise_angle)
+        # CSA gain selection and current full scale as in Emo_lInitFocPar
+        gain = 10.0
+        for g in (20.0, 40.0, 60.0):
+            if foc["FOC_NOM_CUR"] * foc["FOC_R_SHUNT"] * g < 1.25:
+                gain = g
+        self.ki_fs = 5.0 * 2.0 / (foc["FOC_R_SHUNT"] * gain)
+        # speed measurement window Anglersptr
+        x = 60.0 * self.f / (foc["FOC_MAX_SPEED"] * self.p * 4.0)
+        self.window = 32
+        while self.window > 2 and x < self.window:
+            self.window //= 2
+
+    def firmware_gains(self, gains):
+        """Returns the controller gains in physical units for a gain set."""
+        a = gains["CUR_ADJUST"]
+        kp = min(max(a * self.ki_fs * self.l / (256.0 / self.f * KU) * 32767.0, 1.0), 32767.0)
+        ki = min(max(a * self.ki_fs * self.r / (4.0 * KU) * 32767.0, 1.0), 32767.0)
+        return {
+            # V/A, V/A per PWM period
+            "cur_kp": int(kp) / 512.0 * KU / self.ki_fs,
+            "cur_ki": int(ki) / 32768.0 * KU / self.ki_fs,
+            # A/rpm, A/rpm per T2 period
+            "speed_kp": gains["SPEED_KP"] / 512.0 * self.ki_fs / 32767.0,
+            "speed_ki": gains["SPEED_KI"] / 32768.0 * self.ki_fs / 32767.0,
+            # part of the angle error per PWM period
+            "pll": gains["PLL_KP"] / 32768.0,
+        }
+
+
+def wrap(angle):
+    return (angle + math.pi) % (2.0 * math.pi) - math.pi
+
+
+def simulate(motor, g, locked, rng):
+    """Runs one test, returns the time series (t, iq, speed, iq reference, speed reference)."""
+    dt = 1.0 / motor.f
+    sub = 4
+    h = dt / sub
+    r, l, p, psi = motor.r, motor.l, motor.p, motor.psi
+    vmax = motor.udc / math.sqrt(3.0)
+    duration = CURR_STEP_TIME if locked else motor.time
+    steps = int(duration * motor.f)
+    # state
+    speed = 0.0 if locked else motor.speed0
+    omega = speed * 2.0 * math.pi / 60.0
+    theta = 0.0
+    id_ = iq = 0.0
+    vd_c = vq_c = 0.0
+    int_d = int_q = 0.0
+    theta_pll = 0.0
+    angles = [0.0] * (motor.window + 1)
+    pos = 0
+    speed_filt = speed
+    iq_ref = 0.0
+    speed_ref = speed
+    t2_acc = 0.0
+    # preload: stationary operation at speed0 without load
+    int_speed = motor.b * omega / (1.5 * p * psi) if not locked else 0.0
+    if not locked:
+        iq = int_speed
+        int_q = r * iq + omega * p * psi
+        # angle history as written in the periods before, oldest at pos + 1
+        for k in range(motor.window + 1):
+            angles[k] = wrap((k - motor.window - 2 if k else -1) * omega * p * dt)
+    out_t, out_iq, out_speed, out_iqref, out_speedref = [], [], [], [], []
+    for k in range(steps):
+        t = k * dt
+        # measurement
+        c, s = math.cos(theta), math.sin(theta)
+        ia = c * id_ - s * iq + rng.gauss(0.0, motor.noise_i)
+        ib = s * id_ + c * iq + rng.gauss(0.0, motor.noise_i)
+        flux_angle = theta + rng.gauss(0.0, motor.noise_angle)
+        # speed from the angle difference and PLL
+        pos = (pos + 1) % (motor.window + 1)
+        angles[pos] = flux_angle
+        delta = wrap(flux_angle - angles[(pos + 1) % (motor.window + 1)])
+        if locked:
+            theta_c = theta
+        else:
+            theta_pll += g["pll"] * wrap(flux_angle - theta_pll) + delta / motor.window
+            theta_c = theta_pll
+            speed_meas = delta / (motor.window * dt) / p * 60.0 / (2.0 * math.pi)
+            speed_filt += (speed_meas - speed_filt) * dt / motor.filt
+        # speed regulator every T2 period
+        if locked:
+            iq_ref = 0.5 * motor.imax
+        else:
+            t2_acc += dt
+            if t2_acc >= motor.t2:
+                t2_acc -= motor.t2
+                speed_ref = motor.speed1 if t >= SPEED_STEP_AT else motor.speed0
+                err = speed_ref - speed_filt
+                int_speed = min(max(int_speed + g["speed_ki"] * err, -motor.imax), motor.imax)
+                iq_ref = min(max(int_speed + g["speed_kp"] * err, -motor.imax), motor.imax)
+        # current regulators in the controller frame
+        c, s = math.cos(theta_c), math.sin(theta_c)
+        id_c = c * ia + s * ib
+        iq_c = -s * ia + c * ib
+        vd_new, int_d = _pi(g, -id_c, int_d, vmax)
+        vq_new, int_q = _pi(g, iq_ref - iq_c, int_q, vmax)
+        amp = math.hypot(vd_new, vq_new)
+        if amp > vmax:
+            vd_new *= vmax / amp
+            vq_new *= vmax / amp
+        # voltage of the last period to the rotor frame
+        err_angle = theta_c_last - theta if k else 0.0
+        c, s = math.cos(err_angle), math.sin(err_angle)
+        vd = c * vd_c - s * vq_c
+        vq = s * vd_c + c * vq_c
+        vd_c, vq_c = vd_new, vq_new
+        theta_c_last = theta_c
+        load = motor.tload if (not locked and t >= 0.6 * motor.time) else 0.0
+        for _ in range(sub):
+            we = omega * p
+            did = (vd - r * id_ + we * l * iq) / l
+            diq = (vq - r * iq - we * l * id_ - we * psi) / l
+            id_ += did * h
+            iq += diq * h
+            if not locked:
+                omega += (1.5 * p * psi * iq - motor.b * omega - load) / motor.j * h
+            theta += omega * p * h
+        theta = wrap(theta)
+        if abs(iq) > 5.0 * motor.ki_fs or abs(omega) > 1e5:
+            return None
+        out_t.append(t)
+        out_iq.append(iq)
+        out_speed.append(omega * 60.0 / (2.0 * math.pi))
+        out_iqref.append(iq_ref)
+        out_speedref.append(speed_ref)
+    return out_t, out_iq, out_speed, out_iqref, out_speedref
+
+
+def _pi(g, err, integ, vmax):
+    integ = min(max(integ + g["cur_ki"] * err, -vmax), vmax)
+    return min(max(integ + g["cur_kp"] * err, -vmax), vmax), integ
+
+
+def step_metrics(t, y, t0, t1, y0, y1):
+    """Returns rise time (10..90 %) and overshoot (part of the step) in [t0, t1)."""
+    span = y1 - y0
+    t10 = t90 = None
+    peak = 0.0
+    for tk, yk in zip(t, y):
+        if tk < t0 or tk >= t1:
+            continue
+        part = (yk - y0) / span
+        if t10 is None and part >= 0.1:
+            t10 = tk
+        if t90 is None and part >= 0.9:
+            t90 = tk
+        peak = max(peak, part - 1.0)
+    rise = (t90 - t10) if (t10 is not None and t90 is not None) else (t1 - t0)
+    return rise, peak
+
+
+def ripple(values):
+    mean = sum(values) / len(values)
+    return math.sqrt(sum((v - mean) ** 2 for v in values) / len(values))
+
+
+def evaluate(motor, gains, weights, seed=1):
+    """Returns (cost, metrics) of a gain set."""
+    g = motor.firmware_gains(gains)
+    curr = simulate(motor, g, True, random.Random(seed))
+    speed = simulate(motor, g, False, random.Random(seed))
+    if curr is None or speed is None:
+        return 1e6, {"unstable": 1}
+    t, iq, _, _, _ = curr
+    rise_i, os_i = step_metrics(t, iq, 0.0, CURR_STEP_TIME, 0.0, 0.5 * motor.imax)
+    t, iq, n, _, _ = speed
+    t_load = 0.6 * motor.time
+    rise_n, os_n = step_metrics(t, n, SPEED_STEP_AT, t_load, motor.speed0, motor.speed1)
+    after = [nk for tk, nk in zip(t, n) if tk >= t_load]
+    dip = max(0.0, motor.speed1 - min(after)) / (motor.speed1 - motor.speed0)
+    tail = [k for k, tk in enumerate(t) if tk >= 0.8 * motor.time]
+    rip_n = ripple([n[k] for k in tail]) / motor.speed1
+    rip_i = ripple([iq[k] for k in tail]) / motor.imax
+    end_err = abs(sum(n[k] for k in tail) / len(tail) - motor.speed1) / motor.speed1
+    metrics = {"current_rise_ms": rise_i * 1e3, "current_overshoot": os_i, "speed_rise_ms": rise_n * 1e3,
+               "speed_overshoot": os_n, "load_dip": dip, "speed_ripple": rip_n, "iq_ripple": rip_i}
+    cost = (weights[0] * (rise_i / 1e-3 + rise_n / 0.1) + weights[1] * (os_i + os_n + dip)
+            + weights[2] * (rip_n + rip_i) + 10.0 * end_err)
+    return cost, metrics
+
+
+def quantize(x):
+    """Log-space vector to a gain set as the Config Wizard stores it."""
+    gains = {}
+    for v, (name, lo, hi, dec) in zip(x, GAINS):
+        value = min(max(math.exp(v), lo), hi)
+        gains[name] = round(value, dec) if dec else int(round(value))
+    return gains
+
+
+def nelder_mead(func, x0, step, max_eval, tol):
+    n = len(x0)
+    simplex = [list(x0)]
+    for i in range(n):
+        x = list(x0)
+        x[i] += step
+        simplex.append(x)
+    values = [func(x) for x in simplex]
+    evals = n + 1
+    while evals < max_eval:
+        order = sorted(range(n + 1), key=lambda k: values[k])
+        simplex = [simplex[k] for k in order]
+        values = [values[k] for k in order]
+        if values[-1] - values[0] < tol * (abs(values[0]) + 1e-12):
+            break
+        centroid = [sum(x[i] for x in simplex[:-1]) / n for i in range(n)]
+        worst = simplex[-1]
+        xr = [c + (c - w) for c, w in zip(centroid, worst)]
+        fr = func(xr)
+        evals += 1
+        if fr < values[0]:
+            xe = [c + 2.0 * (c - w) for c, w in zip(centroid, worst)]
+            fe = func(xe)
+            evals += 1
+            simplex[-1], values[-1] = (xe, fe) if fe < fr else (xr, fr)
+        elif fr < values[-2]:
+            simplex[-1], values[-1] = xr, fr
+        else:
+            xc = [c + 0.5 * (w - c) for c, w in zip(centroid, worst)]
+            fc = func(xc)
+            evals += 1
+            if fc < values[-1]:
+                simplex[-1], values[-1] = xc, fc
+            else:
+                for k in range(1, n + 1):
+                    simplex[k] = [b + 0.5 * (x - b) for b, x in zip(simplex[0], simplex[k])]
+                    values[k] = func(simplex[k])
+                    evals += 1
+    best = min(range(n + 1), key=lambda k: values[k])
+    return simplex[best], values[best]
+
+
+def _run(job):
+    """One optimizer run on a pool process."""
+    motor, weights, x0, max_eval = job
+    cache = {}
+
+    def func(x):
+        gains = quantize(x)
+        key = tuple(sorted(gains.items()))
+        if key not in cache:
+            cache[key] = evaluate(motor, gains, weights)[0]
+        return cache[key]
+
+    x, cost = nelder_mead(func, x0, 0.5, max_eval, 1e-4)
+    return cost, quantize(x)
+
+
+def fragment(gains, cost, metrics):
+    lines = ["/* pi_tune.py: cost %.4f, %s */" % (cost, ", ".join("%s %.3g" % kv for kv in sorted(metrics.items())))]
+    for name, _, _, dec in GAINS:
+        value = gains[name]
+        if dec:
+            lines.append("#define FOC_%s (%.*f)" % (name, dec, value))
+        else:
+            lines.append("#define FOC_%s (0x%X) /*decimal %d*/" % (name, value, value))
+    return "\n".join(lines)
+
+
+def write_icwp(path, gains):
+    """Stores the gains in the Config Wizard project, CRLF preserved."""
+    with open(path, "rb") as f:
+        data = f.read().decode()
+    for name, _, _, dec in GAINS:
+        value = ("%.*f" % (dec, gains[name])) if dec else str(gains[name])
+        pattern = re.compile(r"(<define>FOC\.%s</define>\s*<value>)[^<]*(</value>\s*<dispValue>)[^<]*(</dispValue>)" % name)
+        data, count = pattern.subn(lambda m: m.group(1) + value + m.group(2) + value + m.group(3), data)
+        if count != 1:
+            raise ValueError("FOC.%s not found in %s" % (name, path))
+    with open(path, "wb") as f:
+        f.write(data.encode())
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--psi", type=float, required=True, help="flux linkage of the permanent magnet in Vs")
+    parser.add_argument("--inertia", type=float, required=True, help="inertia of motor and load in kgm^2")
+    parser.add_argument("--friction", type=float, default=1e-5, help="viscous friction in Nm/(rad/s)")
+    parser.add_argument("--udc", type=float, default=12.0, help="DC-link voltage in V")
+    parser.add_argument("--speed", type=float, help="speed step target in rpm, default 0.75 * FOC_MAX_SPEED")
+    parser.add_argument("--load", type=float, default=0.3, help="load step, part of the torque at FOC_MAX_POS_REF_CUR")
+    parser.add_argument("--time", type=float, default=0.5, help="length of the speed test in s")
+    parser.add_argument("--noise-curr", type=float, default=0.02, help="current measurement noise (sigma) in A")
+    parser.add_argument("--noise-angle", type=float, default=1.0, help="flux angle noise (sigma) in electrical degrees")
+    parser.add_argument("--weights", default="1,5,1", help="weights of rise, overshoot, ripple")
+    parser.add_argument("--starts", type=int, default=4, help="number of optimizer runs")
+    parser.add_argument("--jobs", type=int, default=0, help="pool processes, default number of CPUs")
+    parser.add_argument("--max-eval", type=int, default=120, help="evaluations per optimizer run")
+    parser.add_argument("--seed", type=int, default=1, help="seed of the start points")
+    parser.add_argument("--defines", default=os.path.join(RTE, "foc_defines.h"), help="foc_defines.h with motor data and start gains")
+    parser.add_argument("--icwp", nargs="?", const=os.path.join(RTE, "config.icwp"),
+                        help="write the gains to the Config Wizard project (default RTE config.icwp)")
+    args = parser.parse_args()
+
+    foc = read_defines(args.defines)
+    gpt = read_defines(os.path.join(RTE, "gpt12e_defines.h"))
+    scu = read_defines(os.path.join(RTE, "scu_defines.h"))
+    t2_period = gpt["GPT12E_T2"] * 4.0 / scu["SCU_FSYS"]
+    motor = Motor(foc, args, foc["FOC_PWM_FREQ"], t2_period)
+    weights = [float(w) for w in args.weights.split(",")]
+
+    start = [math.log(foc["FOC_" + name]) for name, _, _, _ in GAINS]
+    rng = random.Random(args.seed)
+    jobs = [(motor, weights, start, args.max_eval)]
+    for _ in range(args.starts - 1):
+        jobs.append((motor, weights, [v + rng.uniform(-1.0, 1.0) for v in start], args.max_eval))
+    base_cost, base_metrics = evaluate(motor, quantize(start), weights)
+    print("# start: cost %.4f %s" % (base_cost, base_metrics), file=sys.stderr)
+
+    pool = multiprocessing.Pool(args.jobs or None)
+    try:
+        results = pool.map(_run, jobs)
+    finally:
+        pool.close()
+    cost, gains = min(results, key=lambda r: r[0])
+    cost, metrics = evaluate(motor, gains, weights)
+    if cost >= base_cost:
+        print("# no improvement over %s" % args.defines, file=sys.stderr)
+        gains, cost, metrics = quantize(start), base_cost, base_metrics
+    print(fragment(gains, cost, metrics))
+    if args.icwp:
+        write_icwp(args.icwp, gains)
+        print("# written to %s, regenerate foc_defines.h with the Config Wizard" % args.icwp, file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
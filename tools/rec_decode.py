@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""Decoder for the flight recorder dump of the sensorless FOC (emo/Emo_Rec.c).
+
+The dump is sent via UART2 (115200 Bd, 8N1) after a fault:
+  0xA5 0x5A version cause depth entry_size entries[depth] checksum
+Entries are sent from oldest to newest, little endian. The checksum is the
+8 bit sum of all bytes after the first sync byte. Version 2 (firmware with
+EMO_CFG_SAT_COUNT_ENABLED) has the saturation counters after the entries:
+  count counters[count] (uint16 little endian, order of EMO_SAT_x)
+
+Usage:
+  rec_decode.py capture.bin          decode a raw capture of the UART
+  rec_decode.py --port COM5          read from serial port (needs pyserial)
+Output is CSV on stdout, one line per PWM period, last line = newest period,
+followed by the non-zero saturation counters as comment lines.
+With --trace the periods are written to a columnar trace file (rec_trace.py).
+"""
+
+import argparse
+import struct
+import sys
+
+VERSIONS = (1, 2)
+HEADER_SIZE = 6
+
+CAUSES = {
+    0: "NONE",
+    1: "STOP",
+    2: "USER",
+    3: "SECTOR",
+    4: "BDRV_OC",
+    5: "BDRV_VCP",
+    6: "TRAP",
+}
+
+STATES = {
+    0: "UNINIT",
+    1: "STOP",
+    2: "START",
+    3: "RUN",
+    4: "FAULT",
+    5: "IDENT",
+    6: "CATCH",
+    7: "IPD",
+}
+
+# Saturation counter sites EMO_SAT_x (emo/Emo.h), index = counter
+SAT_SITES = (
+    "PI_OTHER_I", "PI_OTHER_P", "PI_OTHER_OUT",
+    "PI_CURR_REAL_I", "PI_CURR_REAL_P", "PI_CURR_REAL_OUT",
+    "PI_CURR_IMAG_I", "PI_CURR_IMAG_P", "PI_CURR_IMAG_OUT",
+    "PI_SPEED_I", "PI_SPEED_P", "PI_SPEED_OUT",
+    "PI_FW_I", "PI_FW_P", "PI_FW_OUT",
+    "LP", "CLARKE", "PARK", "INV_PARK", "POLAR", "DCLINK_VOLT", "STAT_VOLT",
+    "DT_COMP", "FLUX_VOLT", "FLUX", "FLUX_ABS", "PLL", "DECOUPLING",
+    "LIMIT_VECT", "DCFACTOR", "IQ_MAX", "START", "SPEED_SCHED",
+)
+
+# TEmo_RecEntry
+ENTRY_FORMAT = "<hhhhHHHHHBB"
+ENTRY_FIELDS = ("PhaseCurrA", "PhaseCurrB", "Id", "Iq", "Angle", "DcLinkVoltage",
+                "comp60up", "comp61up", "comp62up", "Sector", "MotorState")
+
+
+def find_frame(data):
+    """Returns (cause, entries, saturation counters) of the first valid frame in data."""
+    pos = 0
+    while True:
+        pos = data.find(b"\xA5\x5A", pos)
+        if pos < 0 or len(data) < pos + HEADER_SIZE:
+            raise ValueError("no valid frame found")
+        version, cause, depth, size = data[pos + 2:pos + HEADER_SIZE]
+        end = pos + HEADER_SIZE + depth * size
+        if version not in VERSIONS or size != struct.calcsize(ENTRY_FORMAT) or len(data) <= end:
+            pos += 1
+            continue
+        sat_end = end
+        if version == 2:
+            sat_end = end + 1 + 2 * data[end]
+            if len(data) <= sat_end:
+                pos += 1
+                continue
+        if (sum(data[pos + 1:sat_end]) & 0xFF) != data[sat_end]:
+            pos += 1
+            continue
+        body = data[pos + HEADER_SIZE:end]
+        entries = [struct.unpack_from(ENTRY_FORMAT, body, i * size) for i in range(depth)]
+        sat = list(struct.unpack_from("<%dH" % data[end], data, end + 1)) if version == 2 else []
+        return cause, entries, sat
+
+
+def sat_name(index):
+    return SAT_SITES[index] if index < len(SAT_SITES) else "SITE_%d" % index
+
+
+def read_port(port, timeout):
+    import serial
+    with serial.Serial(port, 115200, timeout=timeout) as ser:
+        data = bytearray()
+        while True:
+            chunk = ser.read(1024)
+            if not chunk:
+                return bytes(data)
+            data += chunk
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("file", nargs="?", help="raw capture of the UART output")
+    parser.add_argument("--port", help="serial port to read the dump from")
+    parser.add_argument("--timeout", type=float, default=2.0, help="idle time in s ending the serial capture")
+    parser.add_argument("--trace", help="write a columnar trace file instead of CSV")
+    args = parser.parse_args()
+
+    if args.port:
+        data = read_port(args.port, args.timeout)
+    elif args.file:
+        with open(args.file, "rb") as f:
+            data = f.read()
+    else:
+        parser.error("file or --port required")
+
+    cause, entries, sat = find_frame(data)
+    if args.trace:
+        import rec_trace
+        meta = {"source": "flight recorder", "cause": CAUSES.get(cause, cause)}
+        for n, count in enumerate(sat):
+            if count:
+                meta["sat_" + sat_name(n)] = count
+        with rec_trace.TraceWriter(args.trace, ENTRY_FIELDS, first_period=1 - len(entries), meta=meta) as writer:
+            for entry in entries:
+                writer.append(entry)
+        return 0
+    print("# cause: %s, %d periods" % (CAUSES.get(cause, cause), len(entries)))
+    print("period," + ",".join(ENTRY_FIELDS))
+    for n, entry in enumerate(entries):
+        values = list(entry)
+        values[-1] = STATES.get(values[-1], values[-1])
+        print("%d,%s" % (n - len(entries) + 1, ",".join(str(v) for v in values)))
+    for n, count in enumerate(sat):
+        if count:
+            print("# saturation %s: %d%s" % (sat_name(n), count, " (stopped)" if count == 0xFFFF else ""))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+"""Columnar trace files for long recordings of the sensorless FOC.
+
+One sample per PWM period and signal. Samples are stored per signal in
+chunks of a fixed number of periods: first value, then zig-zag coded deltas
+bit-packed with the width of the largest delta of the chunk. An index at the
+end of the file holds the offset of every chunk, so a period range of one
+signal is read without touching the rest of the file. The reader works on a
+memory map of the file, only the requested chunks are paged in and decoded.
+
+File layout, little endian:
+  header   magic "FOCTRC01", chunk_len u32, num_signals u32,
+           num_periods u64, index_offset u64, first_period i64,
+           signal names (16 bytes each, zero padded)
+  chunks   per chunk and signal: first i32, width u8, count u16, packed data
+  index    per chunk: num_signals x (offset u64, size u32)
+  trailer  metadata (UTF-8 "key=value" lines)
+
+Usage:
+  rec_trace.py info trace.ftr
+  rec_trace.py dump trace.ftr [--signal Iq ...] [--start N] [--stop N]
+The recorder decoder writes this format with rec_decode.py --trace.
+"""
+
+import argparse
+import mmap
+import struct
+import sys
+
+MAGIC = b"FOCTRC01"
+HEADER_FORMAT = "<8sIIQQq"
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT)
+NAME_SIZE = 16
+CHUNK_FORMAT = "<iBH"
+CHUNK_HEADER_SIZE = struct.calcsize(CHUNK_FORMAT)
+INDEX_FORMAT = "<QI"
+INDEX_SIZE = struct.calcsize(INDEX_FORMAT)
+CHUNK_LEN = 4096
+
+
+def zigzag(value):
+    return value << 1 if value >= 0 else (-value << 1) - 1
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def encode_chunk(values):
+    """Returns the encoded chunk of a list of integer samples."""
+    deltas = [zigzag(b - a) for a, b in zip(values, values[1:])]
+    width = max(deltas, default=0).bit_length()
+    packed = bytearray()
+    acc = 0
+    bits = 0
+    for delta in deltas:
+        acc |= delta << bits
+        bits += width
+        while bits >= 8:
+            packed.append(acc & 0xFF)
+            acc >>= 8
+            bits -= 8
+    if bits:
+        packed.append(acc)
+    return struct.pack(CHUNK_FORMAT, values[0], width, len(values)) + bytes(packed)
+
+
+def decode_chunk(buf):
+    """Returns the samples of an encoded chunk (bytes or memoryview)."""
+    first, width, count = struct.unpack_from(CHUNK_FORMAT, buf, 0)
+    values = [first]
+    if width == 0:
+        return values * count
+    mask = (1 << width) - 1
+    acc = 0
+    bits = 0
+    pos = CHUNK_HEADER_SIZE
+    value = first
+    for _ in range(count - 1):
+        while bits < width:
+            acc |= buf[pos] << bits
+            pos += 1
+            bits += 8
+        value += unzigzag(acc & mask)
+        acc >>= width
+        bits -= width
+        values.append(value)
+    return values
+
+
+class TraceWriter:
+    """Writes a trace file, periods are appended in order."""
+
+    def __init__(self, path, signals, chunk_len=CHUNK_LEN, first_period=0, meta=None):
+        if any(len(name.encode()) > NAME_SIZE for name in signals):
+            raise ValueError("signal name longer than %d bytes" % NAME_SIZE)
+        if not 0 < chunk_len <= 0xFFFF:
+            raise ValueError("chunk length out of range")
+        self.signals = list(signals)
+        self.chunk_len = chunk_len
+        self.first_period = first_period
+        self.meta = dict(meta or {})
+        self.periods = 0
+        self.buffer = [[] for _ in self.signals]
+        self.index = []
+        self.file = open(path, "wb")
+        self.file.write(self._header(0))
+
+    def _header(self, index_offset):
+        names = b"".join(name.encode().ljust(NAME_SIZE, b"\0") for name in self.signals)
+        return struct.pack(HEADER_FORMAT, MAGIC, self.chunk_len, len(self.signals), self.periods,
+                           index_offset, self.first_period) + names
+
+    def append(self, sample):
+        """Appends one period, sample holds one integer per signal."""
+        for column, value in zip(self.buffer, sample):
+            column.append(int(value))
+        self.periods += 1
+        if len(self.buffer[0]) == self.chunk_len:
+            self._flush()
+
+    def _flush(self):
+        entry = []
+        for column in self.buffer:
+            data = encode_chunk(column)
+            entry.append((self.file.tell(), len(data)))
+            self.file.write(data)
+            column.clear()
+        self.index.append(entry)
+
+    def close(self):
+        if self.buffer[0]:
+            self._flush()
+        index_offset = self.file.tell()
+        for entry in self.index:
+            for offset, size in entry:
+                self.file.write(struct.pack(INDEX_FORMAT, offset, size))
+        self.file.write("".join("%s=%s\n" % item for item in self.meta.items()).encode())
+        self.file.seek(0)
+        self.file.write(self._header(index_offset))
+        self.file.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+class TraceReader:
+    """Reads a trace file via a memory map."""
+
+    def __init__(self, path):
+        self.file = open(path, "rb")
+        self.map = mmap.mmap(self.file.fileno(), 0, access=mmap.ACCESS_READ)
+        self.view = memoryview(self.map)
+        magic, self.chunk_len, count, self.periods, index_offset, self.first_period = \
+            struct.unpack_from(HEADER_FORMAT, self.map, 0)
+        if magic != MAGIC:
+            raise ValueError("not a trace file")
+        self.signals = [bytes(self.view[HEADER_SIZE + i * NAME_SIZE:HEADER_SIZE + (i + 1) * NAME_SIZE])
+                        .rstrip(b"\0").decode() for i in range(count)]
+        chunks = -(-self.periods // self.chunk_len)
+        self.index = [[struct.unpack_from(INDEX_FORMAT, self.map, index_offset + (c * count + s) * INDEX_SIZE)
+                       for s in range(count)] for c in range(chunks)]
+        meta = bytes(self.view[index_offset + chunks * count * INDEX_SIZE:]).decode()
+        self.meta = dict(line.split("=", 1) for line in meta.splitlines() if "=" in line)
+
+    def read(self, signal, start=None, stop=None):
+        """Returns the samples of one signal for periods start..stop-1."""
+        column = self.signals.index(signal)
+        start = self.first_period if start is None else max(start, self.first_period)
+        stop = self.first_period + self.periods if stop is None else min(stop, self.first_period + self.periods)
+        values = []
+        if stop <= start:
+            return values
+        first = (start - self.first_period) // self.chunk_len
+        last = (stop - 1 - self.first_period) // self.chunk_len
+        for chunk in range(first, last + 1):
+            offset, size = self.index[chunk][column]
+            values += decode_chunk(self.view[offset:offset + size])
+        skip = start - self.first_period - first * self.chunk_len
+        return values[skip:skip + stop - start]
+
+    def close(self):
+        self.view.release()
+        self.map.close()
+        self.file.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("command", choices=("info", "dump"))
+    parser.add_argument("file", help="trace file")
+    parser.add_argument("--signal", action="append", help="signal to dump, default all")
+    parser.add_argument("--start", type=int, help="first period")
+    parser.add_argument("--stop", type=int, help="period after the last one")
+    args = parser.parse_args()
+
+    with TraceReader(args.file) as trace:
+        if args.command == "info":
+            print("periods: %d (%d..%d)" % (trace.periods, trace.first_period,
+                                            trace.first_period + trace.periods - 1))
+            print("chunk length: %d" % trace.chunk_len)
+            print("signals: %s" % ", ".join(trace.signals))
+            for key, value in trace.meta.items():
+                print("%s: %s" % (key, value))
+            return 0
+        signals = args.signal or trace.signals
+        columns = [trace.read(name, args.start, args.stop) for name in signals]
+        first = trace.first_period if args.start is None else max(args.start, trace.first_period)
+        print("period," + ",".join(signals))
+        for n, row in enumerate(zip(*columns)):
+            print("%d,%s" % (first + n, ",".join(str(v) for v in row)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,497 @@
+#!/usr/bin/env python3
+"""Static worst case execution time bound for the FOC interrupt chain.
+
+The linked image (Keil .axf, IAR .out or GCC .elf) is disassembled with
+arm-none-eabi-objdump, the control flow graph of each function is built and
+the longest path is searched. Calls are resolved recursively, the callee
+bound is added at the call site.
+
+Cycle model (Cortex-M3 TRM, instruction timing), every value is the upper
+end of the documented range:
+  ALU, MUL                       1
+  MLA, MLS                       2
+  SMULL, UMULL                   5
+  SMLAL, UMLAL                   7
+  SDIV, UDIV                     12
+  LDR, STR (all sizes)           2
+  LDRD, STRD                     3
+  LDM, STM, PUSH, POP            1 + N
+  B, BL, BX, BLX, CBZ, CBNZ      1 + P (taken), P = 3
+  TBB, TBH                       2 + P
+  write to PC                    + P
+Flash wait states (--wait-states) are added pessimistically for every
+instruction fetch, every load and every pipeline refill. Instructions inside
+IT blocks are always counted as executed.
+
+Interrupt overhead, added to every handler of the chain per activation:
+  exception entry (stacking, vector fetch, first fetch)    12 + 2 * ws
+  exception return (unstacking, refill)                    12 + ws
+  dispatch in the isr.c IRQ handler                        bound of the handler
+The dispatch bound is the longest path of the IRQ handler of isr.c (flag
+checks, clears and the call itself) with all callbacks of isr_defines.h
+counted as 0 cycles, the callback is added separately. Tail-chaining (6
+cycles instead of return and entry) and late arrival (the stacking is
+shared with the preempted entry) only shorten the sequence, so full entry
+and return for every activation is an upper bound.
+
+Loops need a bound given with --loop <header address>=<max iterations>,
+otherwise the analysis stops with an error. Indirect calls and jumps other
+than TBB/TBH and function returns are rejected as well, so the reported
+bound is only printed if it is guaranteed within the model above.
+
+Usage:
+  wcet.py Project.axf
+  wcet.py Project.axf --wait-states 1 --loop 0x1a2c=8
+  wcet.py --listing disasm.txt      use an existing objdump -d listing
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+RTE = os.path.join(HERE, "..", "RTE", "Device", "TLE9879QXA40")
+
+# callback and IRQ handler of isr.c, T12 interrupts on CCU6 SR1 (CCU6_INP)
+ISR_CHAIN = (("Emo_HandleFoc", "CCU6SR1_IRQHandler"),
+             ("Emo_HandleAdc1", "ADC1_IRQHandler"),
+             ("Emo_HandleCCU6ShadowTrans", "CCU6SR1_IRQHandler"))
+T2_CHAIN = (("Emo_HandleT2Overflow", "GPT1_IRQHandler"),)
+
+RE_CALLBACK = re.compile(r"^#define\s+\w+_CALLBACK\s+(\w+)")
+
+# pipeline refill
+P = 3
+
+COND = "(?:eq|ne|cs|hs|cc|lo|mi|pl|vs|vc|hi|ls|ge|lt|gt|le|al)"
+RE_FUNC = re.compile(r"^([0-9a-f]+) <([^>]+)>:$")
+RE_INSN = re.compile(r"^\s*([0-9a-f]+):\s+((?:[0-9a-f]{2,8} ?)+)\s+(\S+)\s*(.*)$")
+RE_TARGET = re.compile(r"^([0-9a-f]+)(?:\s+<([^+>]+)(?:\+0x[0-9a-f]+)?>)?")
+RE_CMP = re.compile(r"^r(\d+), #(\d+)")
+
+
+class AnalysisError(Exception):
+    pass
+
+
+class Insn(object):
+    def __init__(self, addr, size, mnem, ops):
+        self.addr = addr
+        self.size = size
+        self.mnem = mnem
+        self.ops = ops
+        self.data = mnem.startswith(".")
+
+
+def parse_listing(lines):
+    """Returns {function name: [Insn]} of an objdump -d listing."""
+    funcs = {}
+    cur = None
+    for line in lines:
+        line = line.rstrip()
+        m = RE_FUNC.match(line)
+        if m:
+            cur = funcs.setdefault(m.group(2), [])
+            continue
+        m = RE_INSN.match(line)
+        if m and cur is not None:
+            raw = m.group(2).replace(" ", "")
+            ops = m.group(4).split(";")[0].strip()
+            cur.append(Insn(int(m.group(1), 16), len(raw) // 2, m.group(3), ops))
+    return funcs
+
+
+def base_mnem(mnem):
+    return mnem.split(".")[0]
+
+
+def reg_count(ops):
+    regs = ops[ops.find("{") + 1:ops.find("}")]
+    n = 0
+    for part in regs.split(","):
+        part = part.strip()
+        if "-" in part:
+            a, b = part.split("-")
+            n += int(b.strip()[1:]) - int(a.strip()[1:]) + 1
+        elif part:
+            n += 1
+    return n
+
+
+def branch_target(ops):
+    m = RE_TARGET.match(ops)
+    if not m:
+        return None, None
+    return int(m.group(1), 16), m.group(2)
+
+
+def insn_cycles(insn, ws):
+    """Returns (cycles, kind) with kind in
+    'seq', 'jump', 'cond', 'call', 'ret', 'table', 'indirect'."""
+    m = base_mnem(insn.mnem)
+    ops = insn.ops
+    fetch = ws
+    refill = P + ws
+
+    if re.match("^b%s?$" % COND, m):
+        kind = "jump" if len(m) == 1 or m.endswith("al") else "cond"
+        return 1 + refill + fetch, kind
+    if m in ("cbz", "cbnz"):
+        return 1 + refill + fetch, "cond"
+    if m == "bl":
+        return 1 + refill + fetch, "call"
+    if m in ("bx", "blx"):
+        if m == "bx" and ops == "lr":
+            return 1 + refill + fetch, "ret"
+        return 1 + refill + fetch, "indirect"
+    if m in ("tbb", "tbh"):
+        return 2 + refill + fetch + ws, "table"
+    if re.match("^(pop|ldm(ia|db|fd|ea)?)%s?$" % COND, m):
+        n = reg_count(ops)
+        if "pc" in ops:
+            return 1 + n + refill + fetch + ws, "ret"
+        return 1 + n + fetch + ws, "seq"
+    if re.match("^(push|stm(ia|db|fd|ea)?)%s?$" % COND, m):
+        return 1 + reg_count(ops) + fetch, "seq"
+    if re.match("^(ldrd|strd)%s?$" % COND, m):
+        return 3 + fetch + ws, "seq"
+    if re.match("^ldr", m):
+        if ops.startswith("pc, [sp]"):
+            return 2 + refill + fetch + ws, "ret"
+        if ops.startswith("pc,"):
+            return 2 + refill + fetch + ws, "indirect"
+        return 2 + fetch + ws, "seq"
+    if re.match("^str", m):
+        return 2 + fetch, "seq"
+    if re.match("^(sdiv|udiv)%s?$" % COND, m):
+        return 12 + fetch, "seq"
+    if re.match("^(smlal|umlal)%s?$" % COND, m):
+        return 7 + fetch, "seq"
+    if re.match("^(smull|umull)%s?$" % COND, m):
+        return 5 + fetch, "seq"
+    if re.match("^(mla|mls)%s?$" % COND, m):
+        return 2 + fetch, "seq"
+    if re.match("^(msr|mrs|cpsie|cpsid)", m):
+        return 2 + fetch, "seq"
+    if re.match("^(dmb|dsb|isb)", m):
+        return 1 + refill + fetch, "seq"
+    if ops.startswith("pc,") or ops == "pc":
+        return 1 + refill + fetch, "indirect"
+    return 1 + fetch, "seq"
+
+
+class Function(object):
+    def __init__(self, name, insns, ctx):
+        self.name = name
+        self.insns = [i for i in insns if not i.data]
+        self.data = [i for i in insns if i.data]
+        self.ctx = ctx
+        if not self.insns:
+            raise AnalysisError("%s: no instructions" % name)
+        self.start = self.insns[0].addr
+        self.end = insns[-1].addr + insns[-1].size
+        self.index = dict((i.addr, n) for n, i in enumerate(self.insns))
+        self.tail = []
+
+    def table_targets(self, n):
+        """Targets of the TBB/TBH at instruction index n."""
+        insn = self.insns[n]
+        width = 1 if base_mnem(insn.mnem) == "tbb" else 2
+        entries = None
+        # bound of the index from the preceding cmp rX, #imm
+        for k in range(n - 1, max(n - 4, -1), -1):
+            m = RE_CMP.match(self.insns[k].ops)
+            if base_mnem(self.insns[k].mnem) == "cmp" and m:
+                entries = int(m.group(2)) + 1
+                break
+        raw = b""
+        pos = insn.addr + insn.size
+        for d in self.data:
+            if d.addr < pos:
+                continue
+            if d.addr != pos:
+                break
+            value = int(d.ops.split()[0], 0)
+            raw += value.to_bytes(d.size, "little")
+            pos = d.addr + d.size
+            if entries is not None and len(raw) >= entries * width:
+                break
+        if entries is None:
+            entries = len(raw) // width
+        if len(raw) < entries * width or entries == 0:
+            raise AnalysisError("%s: table at 0x%x not resolved" % (self.name, insn.addr))
+        targets = []
+        for e in range(entries):
+            off = int.from_bytes(raw[e * width:(e + 1) * width], "little")
+            t = insn.addr + 4 + 2 * off
+            if t not in self.index:
+                raise AnalysisError("%s: table target 0x%x of 0x%x outside function"
+                                    % (self.name, t, insn.addr))
+            targets.append(t)
+        return sorted(set(targets))
+
+    def build_cfg(self):
+        """Basic blocks: {start: (cycles, [succ], [calls])}."""
+        leaders = set([self.start])
+        succ_of = {}
+        for n, insn in enumerate(self.insns):
+            _, kind = insn_cycles(insn, 0)
+            nxt = self.insns[n + 1].addr if n + 1 < len(self.insns) else None
+            if kind in ("jump", "cond"):
+                target, name = branch_target(insn.ops.split(",")[-1].strip())
+                if target is None or target not in self.index:
+                    # tail call into another function
+                    succ_of[insn.addr] = []
+                    self.tail.append((insn.addr, name))
+                else:
+                    leaders.add(target)
+                    succ_of[insn.addr] = [target]
+                if kind == "cond" and nxt is not None:
+                    succ_of[insn.addr].append(nxt)
+            elif kind == "table":
+                succ_of[insn.addr] = self.table_targets(n)
+                leaders.update(succ_of[insn.addr])
+            elif kind == "ret":
+                succ_of[insn.addr] = []
+            elif kind == "indirect":
+                raise AnalysisError("%s: indirect branch at 0x%x" % (self.name, insn.addr))
+            else:
+                continue
+            if nxt is not None:
+                leaders.add(nxt)
+
+        blocks = {}
+        order = sorted(leaders)
+        for b, start in enumerate(order):
+            stop = order[b + 1] if b + 1 < len(order) else self.end
+            cycles = 0
+            calls = []
+            succ = None
+            for insn in self.insns[self.index[start]:]:
+                if insn.addr >= stop:
+                    break
+                c, kind = insn_cycles(insn, self.ctx.ws)
+                cycles += c
+                if kind == "call":
+                    target, name = branch_target(insn.ops)
+                    calls.append(name or "0x%x" % target)
+                if insn.addr in succ_of:
+                    succ = succ_of[insn.addr]
+            if succ is None:
+                succ = [stop] if stop in self.index else []
+            blocks[start] = (cycles, succ, calls)
+        for addr, name in self.tail:
+            for start in order:
+                if start <= addr:
+                    owner = start
+            blocks[owner][2].append(name)
+        return blocks
+
+    def wcet(self):
+        blocks = self.build_cfg()
+        cost = {}
+        for start, (cycles, succ, calls) in blocks.items():
+            cost[start] = cycles + sum(self.ctx.wcet(c)[0] for c in calls)
+        succ = dict((s, list(b[1])) for s, b in blocks.items())
+
+        # collapse bounded loops (strongly connected components)
+        for scc in sccs(succ):
+            if len(scc) == 1 and scc[0] not in succ[scc[0]]:
+                continue
+            members = set(scc)
+            entries = [s for s in scc if s == self.start or
+                       any(s in succ[p] and p not in members for p in succ)]
+            if len(entries) != 1:
+                raise AnalysisError("%s: irreducible loop at 0x%x" % (self.name, min(scc)))
+            head = entries[0]
+            if head not in self.ctx.loops:
+                raise AnalysisError("%s: loop at 0x%x needs --loop 0x%x=<n>"
+                                    % (self.name, head, head))
+            inner = dict((s, [t for t in succ[s] if t in members and t != head]) for s in scc)
+            if sccs_nontrivial(inner):
+                raise AnalysisError("%s: nested loop in 0x%x not supported" % (self.name, head))
+            body, _ = longest(head, inner, cost)
+            exits = set(t for s in scc for t in succ[s] if t not in members)
+            for s in scc:
+                if s != head:
+                    del succ[s]
+                    del cost[s]
+            cost[head] = body * self.ctx.loops[head]
+            succ[head] = sorted(exits)
+            for s in succ:
+                succ[s] = [head if t in members else t for t in succ[s]]
+        return longest(self.start, succ, cost)
+
+
+def sccs(succ):
+    """Tarjan, returns list of strongly connected components."""
+    index = {}
+    low = {}
+    stack = []
+    on = set()
+    out = []
+    counter = [0]
+
+    def visit(v):
+        index[v] = low[v] = counter[0]
+        counter[0] += 1
+        stack.append(v)
+        on.add(v)
+        for w in succ.get(v, []):
+            if w not in index:
+                visit(w)
+                low[v] = min(low[v], low[w])
+            elif w in on:
+                low[v] = min(low[v], index[w])
+        if low[v] == index[v]:
+            comp = []
+            while True:
+                w = stack.pop()
+                on.discard(w)
+                comp.append(w)
+                if w == v:
+                    break
+            out.append(comp)
+
+    for v in list(succ):
+        if v not in index:
+            visit(v)
+    return out
+
+
+def sccs_nontrivial(succ):
+    return any(len(c) > 1 or c[0] in succ.get(c[0], []) for c in sccs(succ))
+
+
+def longest(start, succ, cost):
+    """Longest path in a DAG from start, returns (cycles, path)."""
+    memo = {}
+
+    def visit(v):
+        if v not in memo:
+            best = (0, [])
+            for w in succ.get(v, []):
+                c = visit(w)
+                if c[0] > best[0]:
+                    best = c
+            memo[v] = (cost[v] + best[0], [v] + best[1])
+        return memo[v]
+
+    sys.setrecursionlimit(10000)
+    return visit(start)
+
+
+class Context(object):
+    def __init__(self, funcs, ws, loops, assume):
+        self.funcs = funcs
+        self.ws = ws
+        self.loops = loops
+        self.assume = assume
+        self.cache = {}
+        self.active = set()
+
+    def wcet(self, name):
+        if name in self.assume:
+            return self.assume[name], []
+        if name not in self.funcs:
+            raise AnalysisError("call to unknown function %s, use --assume %s=<cycles>"
+                                % (name, name))
+        if name in self.active:
+            raise AnalysisError("recursion in %s" % name)
+        if name not in self.cache:
+            self.active.add(name)
+            self.cache[name] = Function(name, self.funcs[name], self).wcet()
+            self.active.discard(name)
+        return self.cache[name]
+
+
+def entry_exit(ws):
+    """Exception entry and return in cycles."""
+    return (12 + 2 * ws) + (12 + ws)
+
+
+def read_callbacks(path):
+    """Returns the callback names registered in isr_defines.h."""
+    names = set()
+    with open(path) as f:
+        for line in f:
+            m = RE_CALLBACK.match(line)
+            if m and m.group(1) != "place_your_function_call_back_here":
+                names.add(m.group(1))
+    return names
+
+
+def key_value(text):
+    key, value = text.split("=")
+    return key, int(value, 0)
+
+
+def addr_value(text):
+    key, value = key_value(text)
+    return int(key, 16), value
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("image", nargs="?", help="linked ELF image")
+    parser.add_argument("--listing", help="objdump -d listing instead of image")
+    parser.add_argument("--objdump", default="arm-none-eabi-objdump")
+    parser.add_argument("--wait-states", type=int, default=1,
+                        help="flash wait states (default 1)")
+    parser.add_argument("--loop", action="append", default=[], type=addr_value,
+                        help="loop bound, <header address>=<iterations>")
+    parser.add_argument("--assume", action="append", default=[], type=key_value,
+                        help="bound of a function not in the image, <name>=<cycles>")
+    parser.add_argument("--fsys", type=float, default=40e6, help="CPU clock in Hz")
+    parser.add_argument("--fpwm", type=float, default=20e3, help="PWM frequency in Hz")
+    parser.add_argument("--func", action="append",
+                        help="analyze only this function (repeatable), no interrupt overhead")
+    parser.add_argument("--isr-defines", default=os.path.join(RTE, "isr_defines.h"),
+                        help="isr_defines.h with the registered callbacks")
+    args = parser.parse_args()
+
+    if args.listing:
+        with open(args.listing) as f:
+            lines = f.readlines()
+    elif args.image:
+        lines = subprocess.check_output([args.objdump, "-d", args.image],
+                                        universal_newlines=True).splitlines()
+    else:
+        parser.error("image or --listing required")
+
+    funcs = parse_listing(lines)
+    ctx = Context(funcs, args.wait_states, dict(args.loop), dict(args.assume))
+    total = 0
+    try:
+        if args.func:
+            for name in args.func:
+                cycles, path = ctx.wcet(name)
+                print("%-28s %6d cycles  %7.2f us" % (name, cycles, cycles * 1e6 / args.fsys))
+                print("  path: %s" % " ".join("%x" % a for a in path))
+            return
+        # IRQ handlers with all callbacks at 0 cycles: dispatch only
+        assume = dict((c, 0) for c in read_callbacks(args.isr_defines))
+        assume.update(dict(args.assume))
+        dispatch = Context(funcs, args.wait_states, dict(args.loop), assume)
+        overhead = entry_exit(args.wait_states)
+        for name, handler in ISR_CHAIN + T2_CHAIN:
+            cycles, path = ctx.wcet(name)
+            extra = overhead + dispatch.wcet(handler)[0]
+            print("%-28s %6d cycles  %7.2f us" % (name, cycles + extra,
+                                                  (cycles + extra) * 1e6 / args.fsys))
+            print("  callback %d, %s dispatch and entry/return %d" % (cycles, handler, extra))
+            print("  path: %s" % " ".join("%x" % a for a in path))
+            if (name, handler) in ISR_CHAIN:
+                total += cycles + extra
+    except AnalysisError as e:
+        sys.exit("error: %s" % e)
+
+    period = args.fsys / args.fpwm
+    print("PWM period chain           %6d cycles  %5.1f %% of %d" %
+          (total, 100.0 * total / period, period))
+
+
+if __name__ == "__main__":
+    main()